@@ -1,106 +1,3031 @@
 /*
  * Single Source Shortest Path using Dijkstra's Algorithm
- * 
+ *
+ * The graph is stored in Compressed Sparse Row (CSR) form: the edges leaving
+ * vertex u are adj[rowStart[u] .. rowStart[u+1]-1] with matching weight[].
+ * The frontier is kept in an indexed binary min-heap so that the closest
+ * unsettled vertex is found in O(log V) and a shorter distance can be pushed
+ * into the heap in place (decrease-key).
+ *
  * Pseudocode:
  * 1. Initialize distances of all vertices as INFINITE
- * 2. Set distance of source vertex as 0
- * 3. Create a set to keep track of vertices included in shortest path tree
- * 4. While all vertices are not included in the set:
- *    a. Pick a vertex u which is not in set and has minimum distance value
- *    b. Include u to the set
- *    c. Update distance value of all adjacent vertices of u
- *       - For each adjacent vertex v, if sum of distance[u] and weight(u,v)
- *         is less than distance[v], then update distance[v]
- * 5. Print the shortest distances from source to all vertices
+ * 2. Set distance of source vertex as 0 and insert it into the min-heap
+ * 3. While the heap is not empty:
+ *    a. Extract the vertex u with minimum distance value (u is now settled)
+ *    b. For each edge (u, v) in the CSR row of u:
+ *       - If dist[u] + weight(u,v) is less than dist[v], update dist[v]
+ *       - Insert v into the heap, or decrease its key if already there
+ * 4. Print the shortest distances from source to all vertices
+ *
+ * Time Complexity: O((V + E) log V)
+ * Space Complexity: O(V + E)
+ *
+ * When all weights are small non-negative integers (at most C), Dial's
+ * algorithm can replace the heap with C+1 circular buckets indexed by
+ * dist % (C+1). Every queued vertex lies within C of the current minimum, so
+ * the buckets never alias and finding the next vertex is a forward scan:
+ *    a. Keep a cursor d, starting at 0
+ *    b. While bucket[d % (C+1)] is empty, increment d
+ *    c. Remove any vertex u from that bucket; it is settled with dist[u] = d
+ *    d. On relaxation, unlink v from its old bucket and link it into the new one
+ * Time Complexity: O(V * C + E), Space Complexity: O(V + E + C)
+ *
+ * Delta-stepping (Meyer and Sanders) relaxes many vertices at once on several
+ * threads. Buckets hold distance ranges [i*delta, (i+1)*delta):
+ *    a. Take the lowest non-empty bucket B
+ *    b. All threads remove the vertices of B and relax their light edges
+ *       (weight < delta) in parallel; repeat while B receives new vertices
+ *    c. Relax the heavy edges (weight >= delta) of every vertex removed from B
+ *    d. Continue with the next non-empty bucket
+ * Distances only decrease through an atomic compare-and-swap, so the result
+ * is exactly the same as the sequential algorithm.
+ *
+ * For many queries against one graph, dijkstraBatch() hands the sources out to
+ * worker threads. Each thread keeps one scratch space (distances, heap) for
+ * all of its queries; distances carry an epoch stamp, so a new query starts
+ * in O(1) instead of re-initialising V entries.
+ *
+ * When only one target matters, dijkstraPointToPoint() stops as soon as the
+ * target is settled, and dijkstraBidirectional() searches forward from the
+ * source and backward from the target (on the reverse graph) until the two
+ * searches meet. Both record parent pointers to return the path itself.
+ *
+ * A* goes further on graphs with extra knowledge: a heuristic h(v) that never
+ * overestimates the distance from v to the target (straight-line distance on
+ * coordinates, or landmark distances with the triangle inequality, ALT). The
+ * heap is ordered by dist[v] + h(v), so vertices leading away from the target
+ * are settled late or not at all.
+ *
+ * For graphs that rarely change but are queried constantly, a contraction
+ * hierarchy moves most of the work to preprocessing:
+ *    a. Remove ("contract") vertices one at a time, least important first:
+ *       fewest shortcuts added per edge removed, fewest contracted
+ *       neighbours, lowest level in the hierarchy
+ *    b. When removing v, add a shortcut u -> x for every path u -> v -> x that
+ *       is the only shortest path (no "witness" path avoids v)
+ *    c. A query searches forward from the source and backward from the target,
+ *       both only along edges to vertices contracted later, and takes the best
+ *       vertex reached from both sides
+ * Preprocessing pays off on road networks, where a few fast roads carry most
+ * shortest paths; a grid with uniform random weights has no such hierarchy,
+ * so its shortcuts and preprocessing time grow faster than linearly.
+ *
+ * When only a few edge weights change, DynamicSSSP keeps dist[] and the
+ * shortest path tree and repairs them: a cheaper edge pushes the improvement
+ * forward as in Dijkstra, and a dearer tree edge recomputes only the subtree
+ * below it.
+ *
+ * The engine above uses int weights. DEFINE_SHORTEST_PATH_KERNEL generates
+ * the graph and Dijkstra for other weight types from one source, on the same
+ * DEFINE_INDEXED_HEAP heap as the int engine: uint32 weights with 64-bit
+ * distances, uint64 weights, and float and double weights for fractional
+ * costs. A distance too large for its type is reported, not wrapped around.
+ *
+ * benchmarkReorder() renumbers a grid whose input numbering is random (like
+ * a road network in arbitrary order) with the orders of graph_reorder.h and
+ * times the same searches on every numbering; dist[v] is read back as
+ * dist[newId[v]] and checked against the input numbering.
+ *
+ * Any graph can also be read from a graph file (graph_file.h): the file is
+ * memory-mapped and its CSR arrays are used in place, with no parsing.
+ *
+ * The original O(V^2) adjacency-matrix version is kept as dijkstraMatrix()
+ * and is only used as a reference to check the heap-based results.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "graph_file.h"
+#include "graph_reorder.h"
 
-#define V 9  // Number of vertices in the graph
+// Structure to represent a weighted directed graph in CSR form
+struct CSRGraph {
+    int numVertices;
+    int numEdges;
+    int* rowStart;  // rowStart[u] .. rowStart[u+1]-1 index the edges of u
+    int* adj;       // adj[e] is the target vertex of edge e
+    int* weight;    // weight[e] is the weight of edge e
+};
 
-// Function to find the vertex with minimum distance value from the set of vertices
-// not yet included in shortest path tree
-int minDistance(int dist[], bool sptSet[]) {
-    int min = INT_MAX, min_index;
-    
-    for (int v = 0; v < V; v++) {
-        if (sptSet[v] == false && dist[v] <= min) {
-            min = dist[v];
-            min_index = v;
+// Priority queue used to pick the next vertex to settle
+enum QueueType {
+    BINARY_HEAP,   // Indexed binary heap, any non-negative weights
+    DIAL_BUCKETS   // Dial's circular buckets, small integer weights
+};
+
+// Indexed binary min-heap of vertices keyed by distance
+// DEFINE_INDEXED_HEAP generates the heap for one key type, so the int engine
+// below (empty SUFFIX: struct MinHeap, siftUp, ...) and the typed kernels
+// share one source. The key array belongs to the caller (it is dist[]).
+#define DEFINE_INDEXED_HEAP(SUFFIX, KEY_T)                                                 \
+                                                                                           \
+struct MinHeap##SUFFIX {                                                                   \
+    int size;                                                                              \
+    int* vertex;  /* vertex[i] is the vertex stored at heap slot i */                     \
+    int* pos;     /* pos[v] is the heap slot of v, or -1 if v is not in the heap */       \
+    KEY_T* key;   /* key[v] is the current distance of v (shared with dist[]) */          \
+};                                                                                         \
+                                                                                           \
+/* Create an empty heap able to hold every vertex */                                      \
+struct MinHeap##SUFFIX* createMinHeap##SUFFIX(int numVertices, KEY_T key[]) {              \
+    struct MinHeap##SUFFIX* heap =                                                         \
+        (struct MinHeap##SUFFIX*)malloc(sizeof(struct MinHeap##SUFFIX));                   \
+    heap->size = 0;                                                                        \
+    heap->vertex = (int*)malloc(numVertices * sizeof(int));                                \
+    heap->pos = (int*)malloc(numVertices * sizeof(int));                                   \
+    heap->key = key;                                                                       \
+    for (int v = 0; v < numVertices; v++)                                                  \
+        heap->pos[v] = -1;                                                                 \
+    return heap;                                                                           \
+}                                                                                          \
+                                                                                           \
+void freeMinHeap##SUFFIX(struct MinHeap##SUFFIX* heap) {                                   \
+    free(heap->vertex);                                                                    \
+    free(heap->pos);                                                                       \
+    free(heap);                                                                            \
+}                                                                                          \
+                                                                                           \
+/* Move the vertex at slot i up until its parent has a smaller key */                     \
+static inline void siftUp##SUFFIX(struct MinHeap##SUFFIX* heap, int i) {                   \
+    int v = heap->vertex[i];                                                               \
+    KEY_T k = heap->key[v];                                                                \
+    while (i > 0) {                                                                        \
+        int parent = (i - 1) / 2;                                                          \
+        int p = heap->vertex[parent];                                                      \
+        if (heap->key[p] <= k)                                                             \
+            break;                                                                         \
+        heap->vertex[i] = p;                                                               \
+        heap->pos[p] = i;                                                                  \
+        i = parent;                                                                        \
+    }                                                                                      \
+    heap->vertex[i] = v;                                                                   \
+    heap->pos[v] = i;                                                                      \
+}                                                                                          \
+                                                                                           \
+/* Move the vertex at slot i down until both children have larger keys */                 \
+static inline void siftDown##SUFFIX(struct MinHeap##SUFFIX* heap, int i) {                 \
+    int v = heap->vertex[i];                                                               \
+    KEY_T k = heap->key[v];                                                                \
+    while (true) {                                                                         \
+        int child = 2 * i + 1;                                                             \
+        if (child >= heap->size)                                                           \
+            break;                                                                         \
+        if (child + 1 < heap->size                                                         \
+            && heap->key[heap->vertex[child + 1]] < heap->key[heap->vertex[child]])        \
+            child++;                                                                       \
+        int c = heap->vertex[child];                                                       \
+        if (heap->key[c] >= k)                                                             \
+            break;                                                                         \
+        heap->vertex[i] = c;                                                               \
+        heap->pos[c] = i;                                                                  \
+        i = child;                                                                         \
+    }                                                                                      \
+    heap->vertex[i] = v;                                                                   \
+    heap->pos[v] = i;                                                                      \
+}                                                                                          \
+                                                                                           \
+/* Insert v, or restore heap order after key[v] has been lowered (decrease-key) */        \
+static inline void heapPushOrDecrease##SUFFIX(struct MinHeap##SUFFIX* heap, int v) {       \
+    if (heap->pos[v] == -1) {                                                              \
+        heap->vertex[heap->size] = v;                                                      \
+        heap->pos[v] = heap->size;                                                         \
+        heap->size++;                                                                      \
+    }                                                                                      \
+    siftUp##SUFFIX(heap, heap->pos[v]);                                                    \
+}                                                                                          \
+                                                                                           \
+/* Remove and return the vertex with the smallest key */                                  \
+static inline int heapExtractMin##SUFFIX(struct MinHeap##SUFFIX* heap) {                   \
+    int min = heap->vertex[0];                                                             \
+    heap->pos[min] = -1;                                                                   \
+    heap->size--;                                                                          \
+    if (heap->size > 0) {                                                                  \
+        heap->vertex[0] = heap->vertex[heap->size];                                        \
+        siftDown##SUFFIX(heap, 0);                                                         \
+    }                                                                                      \
+    return min;                                                                            \
+}
+
+DEFINE_INDEXED_HEAP(, int)
+
+// Function to build a CSR graph from an edge list (src[i] -> dest[i], w[i])
+// Edges are bucketed by source with a counting sort, so this runs in O(V + E)
+struct CSRGraph* createCSRGraph(int numVertices, int numEdges,
+                                const int src[], const int dest[], const int w[]) {
+    struct CSRGraph* graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    graph->numVertices = numVertices;
+    graph->numEdges = numEdges;
+    graph->rowStart = (int*)calloc(numVertices + 1, sizeof(int));
+    graph->adj = (int*)malloc(numEdges * sizeof(int));
+    graph->weight = (int*)malloc(numEdges * sizeof(int));
+
+    // Count the out-degree of every vertex
+    for (int i = 0; i < numEdges; i++)
+        graph->rowStart[src[i] + 1]++;
+
+    // Prefix sum turns degrees into row offsets
+    for (int u = 0; u < numVertices; u++)
+        graph->rowStart[u + 1] += graph->rowStart[u];
+
+    // Scatter every edge into its row
+    int* next = (int*)malloc(numVertices * sizeof(int));
+    for (int u = 0; u < numVertices; u++)
+        next[u] = graph->rowStart[u];
+    for (int i = 0; i < numEdges; i++) {
+        int e = next[src[i]]++;
+        graph->adj[e] = dest[i];
+        graph->weight[e] = w[i];
+    }
+    free(next);
+
+    return graph;
+}
+
+// Function to build a CSR graph from an n x n row-major adjacency matrix
+// matrix[i*n + j] is the weight of edge i -> j (0 means no edge)
+struct CSRGraph* createCSRFromMatrix(int n, const int matrix[]) {
+    int numEdges = 0;
+    for (int i = 0; i < n * n; i++)
+        if (matrix[i])
+            numEdges++;
+
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    int* w = (int*)malloc(numEdges * sizeof(int));
+    int e = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (matrix[i * n + j]) {
+                src[e] = i;
+                dest[e] = j;
+                w[e] = matrix[i * n + j];
+                e++;
+            }
+        }
+    }
+
+    struct CSRGraph* graph = createCSRGraph(n, numEdges, src, dest, w);
+    free(src);
+    free(dest);
+    free(w);
+    return graph;
+}
+
+// Function to free a CSR graph
+void freeCSRGraph(struct CSRGraph* graph) {
+    free(graph->rowStart);
+    free(graph->adj);
+    free(graph->weight);
+    free(graph);
+}
+
+// Dijkstra's algorithm with the indexed binary heap as priority queue
+void dijkstraBinaryHeap(const struct CSRGraph* graph, int src, int dist[]) {
+    struct MinHeap* heap = createMinHeap(graph->numVertices, dist);
+
+    // Initialize all distances as INFINITE
+    for (int i = 0; i < graph->numVertices; i++)
+        dist[i] = INT_MAX;
+
+    // Distance of source vertex from itself is always 0
+    dist[src] = 0;
+    heapPushOrDecrease(heap, src);
+
+    while (heap->size > 0) {
+        // The minimum distance vertex in the heap is settled
+        int u = heapExtractMin(heap);
+
+        // Relax every edge leaving u
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            int v = graph->adj[e];
+            int alt = dist[u] + graph->weight[e];
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                heapPushOrDecrease(heap, v);
+            }
+        }
+    }
+
+    freeMinHeap(heap);
+}
+
+// Function to find the largest edge weight (the C of Dial's algorithm)
+int maxEdgeWeight(const struct CSRGraph* graph) {
+    int maxWeight = 0;
+    for (int e = 0; e < graph->numEdges; e++)
+        if (graph->weight[e] > maxWeight)
+            maxWeight = graph->weight[e];
+    return maxWeight;
+}
+
+// Dijkstra's algorithm with Dial's circular bucket queue as priority queue
+// Each bucket is an intrusive doubly linked list threaded through next[]/prev[]
+void dijkstraDial(const struct CSRGraph* graph, int src, int dist[]) {
+    int n = graph->numVertices;
+    int numBuckets = maxEdgeWeight(graph) + 1;
+    int* bucketHead = (int*)malloc(numBuckets * sizeof(int));
+    int* next = (int*)malloc(n * sizeof(int));
+    int* prev = (int*)malloc(n * sizeof(int));
+    bool* queued = (bool*)malloc(n * sizeof(bool));
+    int numQueued = 0;
+
+    for (int b = 0; b < numBuckets; b++)
+        bucketHead[b] = -1;
+    for (int i = 0; i < n; i++) {
+        dist[i] = INT_MAX;
+        queued[i] = false;
+    }
+
+    // Put the source alone in bucket 0
+    dist[src] = 0;
+    next[src] = prev[src] = -1;
+    bucketHead[0] = src;
+    queued[src] = true;
+    numQueued = 1;
+
+    int d = 0;       // Distance of the bucket being scanned
+    int bucket = 0;  // d % numBuckets, kept incrementally
+    while (numQueued > 0) {
+        // Advance to the next non-empty bucket
+        while (bucketHead[bucket] == -1) {
+            d++;
+            if (++bucket == numBuckets)
+                bucket = 0;
+        }
+
+        // Pop the head of the bucket; it is settled at distance d
+        int u = bucketHead[bucket];
+        bucketHead[bucket] = next[u];
+        if (next[u] != -1)
+            prev[next[u]] = -1;
+        queued[u] = false;
+        numQueued--;
+
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            int v = graph->adj[e];
+            int alt = d + graph->weight[e];
+            if (alt >= dist[v])
+                continue;
+
+            // Unlink v from the bucket of its old distance
+            if (queued[v]) {
+                if (prev[v] != -1)
+                    next[prev[v]] = next[v];
+                else
+                    bucketHead[dist[v] % numBuckets] = next[v];
+                if (next[v] != -1)
+                    prev[next[v]] = prev[v];
+            } else {
+                queued[v] = true;
+                numQueued++;
+            }
+
+            // Link v at the head of the bucket of its new distance
+            dist[v] = alt;
+            int b = alt % numBuckets;
+            prev[v] = -1;
+            next[v] = bucketHead[b];
+            if (bucketHead[b] != -1)
+                prev[bucketHead[b]] = v;
+            bucketHead[b] = v;
+        }
+    }
+
+    free(bucketHead);
+    free(next);
+    free(prev);
+    free(queued);
+}
+
+// Function to implement Dijkstra's single source shortest path algorithm
+// dist[i] receives the shortest distance from src to i (INT_MAX if unreachable)
+// DIAL_BUCKETS is only valid for non-negative integer weights; its running
+// time grows with the largest weight, so use it for small weights only
+void dijkstra(const struct CSRGraph* graph, int src, int dist[], enum QueueType queue) {
+    if (queue == DIAL_BUCKETS)
+        dijkstraDial(graph, src, dist);
+    else
+        dijkstraBinaryHeap(graph, src, dist);
+}
+
+// Function to get the name of a priority queue type
+const char* queueName(enum QueueType queue) {
+    return queue == DIAL_BUCKETS ? "dial" : "heap";
+}
+
+// Growable array of ints used for per-thread buckets and work lists
+struct IntVector {
+    int* data;
+    int size;
+    int capacity;
+};
+
+// Append a value to a vector, doubling its capacity when full
+void vectorPush(struct IntVector* vec, int value) {
+    if (vec->size == vec->capacity) {
+        vec->capacity = vec->capacity ? 2 * vec->capacity : 16;
+        vec->data = (int*)realloc(vec->data, vec->capacity * sizeof(int));
+    }
+    vec->data[vec->size++] = value;
+}
+
+// Per-thread state of delta-stepping
+// Buckets are circular: a pending vertex is at most maxWeight/delta + 1
+// buckets ahead of the current one, so numSlots = maxWeight/delta + 2 suffice
+struct DeltaThread {
+    struct IntVector* slots;  // slots[b % numSlots] holds this thread's bucket b
+    struct IntVector settled; // Vertices removed from the current bucket
+    int nextBucket;           // Smallest non-empty bucket after the current one
+    int count;                // Size of this thread's share of the frontier
+    int offset;               // Where that share starts in the shared frontier
+};
+
+// Shared state of one delta-stepping run
+struct DeltaStepping {
+    const struct CSRGraph* graph;
+    int delta;
+    int numThreads;
+    int numSlots;
+    atomic_int* dist;
+    atomic_int* settledIn;    // Last bucket in which a vertex was settled
+    int* frontier;            // Vertices of the current bucket, gathered from all threads
+    int frontierSize;
+    int frontierCapacity;
+    int bucket;               // Index of the bucket being processed
+    struct DeltaThread* threads;
+    pthread_barrier_t barrier;
+};
+
+// Argument passed to each worker thread
+struct DeltaWorker {
+    struct DeltaStepping* ds;
+    int id;
+};
+
+// Lower dist[v] to newDist if smaller, and file v under its new bucket
+void deltaRelax(struct DeltaStepping* ds, struct DeltaThread* self, int v, int newDist) {
+    int old = atomic_load_explicit(&ds->dist[v], memory_order_relaxed);
+    while (newDist < old) {
+        if (atomic_compare_exchange_weak_explicit(&ds->dist[v], &old, newDist,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            vectorPush(&self->slots[(newDist / ds->delta) % ds->numSlots], v);
+            return;
+        }
+    }
+}
+
+// Body of every worker thread; all threads step through the buckets together
+void* deltaWorker(void* arg) {
+    struct DeltaWorker* worker = (struct DeltaWorker*)arg;
+    struct DeltaStepping* ds = worker->ds;
+    struct DeltaThread* self = &ds->threads[worker->id];
+    const struct CSRGraph* graph = ds->graph;
+    int delta = ds->delta;
+
+    while (true) {
+        int b = ds->bucket;
+        struct IntVector* slot = &self->slots[b % ds->numSlots];
+
+        // Light phase: empty bucket b, relaxing only edges lighter than delta.
+        // Those can put vertices back into bucket b, so repeat until it stays empty
+        while (true) {
+            self->count = slot->size;
+            pthread_barrier_wait(&ds->barrier);
+
+            // One thread lays out every thread's share of the frontier
+            if (worker->id == 0) {
+                int total = 0;
+                for (int t = 0; t < ds->numThreads; t++) {
+                    ds->threads[t].offset = total;
+                    total += ds->threads[t].count;
+                }
+                if (total > ds->frontierCapacity) {
+                    ds->frontierCapacity = 2 * total;
+                    free(ds->frontier);
+                    ds->frontier = (int*)malloc(ds->frontierCapacity * sizeof(int));
+                }
+                ds->frontierSize = total;
+            }
+            pthread_barrier_wait(&ds->barrier);
+
+            if (ds->frontierSize == 0)
+                break;
+            if (slot->size > 0)
+                memcpy(ds->frontier + self->offset, slot->data, slot->size * sizeof(int));
+            slot->size = 0;
+            pthread_barrier_wait(&ds->barrier);
+
+            for (int i = worker->id; i < ds->frontierSize; i += ds->numThreads) {
+                int u = ds->frontier[i];
+                int d = atomic_load_explicit(&ds->dist[u], memory_order_relaxed);
+                if (d / delta != b)
+                    continue;  // Stale entry, u was settled in an earlier bucket
+
+                // Remember u once for the heavy phase
+                if (atomic_exchange_explicit(&ds->settledIn[u], b, memory_order_relaxed) != b)
+                    vectorPush(&self->settled, u);
+
+                for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)
+                    if (graph->weight[e] < delta)
+                        deltaRelax(ds, self, graph->adj[e], d + graph->weight[e]);
+            }
+            pthread_barrier_wait(&ds->barrier);
+        }
+
+        // Heavy phase: bucket b is final, relax its heavy edges once.
+        // They always land in a later bucket
+        for (int i = 0; i < self->settled.size; i++) {
+            int u = self->settled.data[i];
+            int d = atomic_load_explicit(&ds->dist[u], memory_order_relaxed);
+            for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)
+                if (graph->weight[e] >= delta)
+                    deltaRelax(ds, self, graph->adj[e], d + graph->weight[e]);
+        }
+        self->settled.size = 0;
+
+        // Find the next non-empty bucket of this thread
+        self->nextBucket = INT_MAX;
+        for (int k = 1; k < ds->numSlots; k++) {
+            if (self->slots[(b + k) % ds->numSlots].size > 0) {
+                self->nextBucket = b + k;
+                break;
+            }
+        }
+        pthread_barrier_wait(&ds->barrier);
+
+        if (worker->id == 0) {
+            int next = INT_MAX;
+            for (int t = 0; t < ds->numThreads; t++)
+                if (ds->threads[t].nextBucket < next)
+                    next = ds->threads[t].nextBucket;
+            ds->bucket = next;
+        }
+        pthread_barrier_wait(&ds->barrier);
+
+        if (ds->bucket == INT_MAX)
+            break;
+    }
+
+    return NULL;
+}
+
+// Parallel delta-stepping single source shortest paths
+// Vertices are grouped into buckets of width delta by tentative distance.
+// All threads empty the lowest bucket together, relaxing light edges
+// (weight < delta) until it stops refilling, then relax the heavy edges of the
+// settled vertices once. Small delta approaches Dijkstra (little parallelism),
+// large delta approaches Bellman-Ford (more parallelism, more wasted work).
+// The distances are exact, so dist[] is identical to dijkstra()
+void dijkstraDeltaStepping(const struct CSRGraph* graph, int src, int dist[],
+                           int delta, int numThreads) {
+    int n = graph->numVertices;
+    struct DeltaStepping ds;
+    ds.graph = graph;
+    ds.delta = delta;
+    ds.numThreads = numThreads;
+    ds.numSlots = maxEdgeWeight(graph) / delta + 2;
+    ds.dist = (atomic_int*)malloc(n * sizeof(atomic_int));
+    ds.settledIn = (atomic_int*)malloc(n * sizeof(atomic_int));
+    ds.frontier = NULL;
+    ds.frontierSize = 0;
+    ds.frontierCapacity = 0;
+    ds.bucket = 0;
+    ds.threads = (struct DeltaThread*)calloc(numThreads, sizeof(struct DeltaThread));
+    pthread_barrier_init(&ds.barrier, NULL, numThreads);
+
+    for (int i = 0; i < n; i++) {
+        atomic_init(&ds.dist[i], INT_MAX);
+        atomic_init(&ds.settledIn[i], -1);
+    }
+    for (int t = 0; t < numThreads; t++)
+        ds.threads[t].slots = (struct IntVector*)calloc(ds.numSlots, sizeof(struct IntVector));
+
+    atomic_store(&ds.dist[src], 0);
+    vectorPush(&ds.threads[0].slots[0], src);
+
+    // Thread 0 is the calling thread, the rest are started here
+    pthread_t* tids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    struct DeltaWorker* workers = (struct DeltaWorker*)malloc(numThreads * sizeof(struct DeltaWorker));
+    for (int t = 0; t < numThreads; t++) {
+        workers[t].ds = &ds;
+        workers[t].id = t;
+    }
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&tids[t], NULL, deltaWorker, &workers[t]);
+    deltaWorker(&workers[0]);
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(tids[t], NULL);
+
+    for (int i = 0; i < n; i++)
+        dist[i] = atomic_load(&ds.dist[i]);
+
+    for (int t = 0; t < numThreads; t++) {
+        for (int k = 0; k < ds.numSlots; k++)
+            free(ds.threads[t].slots[k].data);
+        free(ds.threads[t].slots);
+        free(ds.threads[t].settled.data);
+    }
+    pthread_barrier_destroy(&ds.barrier);
+    free(ds.threads);
+    free(ds.frontier);
+    free(ds.dist);
+    free(ds.settledIn);
+    free(tids);
+    free(workers);
+}
+
+// Reusable per-thread scratch space for many shortest path queries
+// A distance is valid only if stamp[v] == epoch, so starting a new query is
+// O(1): bump the epoch instead of resetting all V distances
+struct SearchScratch {
+    int numVertices;
+    int epoch;
+    int* stamp;             // Epoch in which dist[v] was last written
+    int* dist;              // Tentative distances of the current query
+    int* parent;            // Predecessor on the shortest path (point-to-point queries)
+    struct MinHeap* heap;   // Keyed by dist[], empty between queries
+};
+
+// Function to create scratch space for graphs with numVertices vertices
+struct SearchScratch* createSearchScratch(int numVertices) {
+    struct SearchScratch* scratch = (struct SearchScratch*)malloc(sizeof(struct SearchScratch));
+    scratch->numVertices = numVertices;
+    scratch->epoch = 0;
+    scratch->stamp = (int*)calloc(numVertices, sizeof(int));
+    scratch->dist = (int*)malloc(numVertices * sizeof(int));
+    scratch->parent = (int*)malloc(numVertices * sizeof(int));
+    scratch->heap = createMinHeap(numVertices, scratch->dist);
+    return scratch;
+}
+
+// Function to free scratch space
+void freeSearchScratch(struct SearchScratch* scratch) {
+    freeMinHeap(scratch->heap);
+    free(scratch->stamp);
+    free(scratch->dist);
+    free(scratch->parent);
+    free(scratch);
+}
+
+// Start a new query: every distance becomes INFINITE in O(1)
+void scratchNewQuery(struct SearchScratch* scratch) {
+    if (++scratch->epoch == INT_MAX) {
+        // Stamps would become ambiguous after wrap-around, clear them once
+        memset(scratch->stamp, 0, scratch->numVertices * sizeof(int));
+        scratch->epoch = 1;
+    }
+}
+
+// Distance of v in the current query (INT_MAX if not reached)
+int scratchDistance(const struct SearchScratch* scratch, int v) {
+    return scratch->stamp[v] == scratch->epoch ? scratch->dist[v] : INT_MAX;
+}
+
+// Binary-heap Dijkstra from src that leaves its distances in the scratch space
+void dijkstraScratch(const struct CSRGraph* graph, int src, struct SearchScratch* scratch) {
+    struct MinHeap* heap = scratch->heap;
+    int* dist = scratch->dist;
+    int* stamp = scratch->stamp;
+
+    scratchNewQuery(scratch);
+    int epoch = scratch->epoch;
+    stamp[src] = epoch;
+    dist[src] = 0;
+    heapPushOrDecrease(heap, src);
+
+    while (heap->size > 0) {
+        int u = heapExtractMin(heap);
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            int v = graph->adj[e];
+            int alt = dist[u] + graph->weight[e];
+            if (stamp[v] != epoch) {
+                stamp[v] = epoch;
+                dist[v] = alt;
+                heapPushOrDecrease(heap, v);
+            } else if (alt < dist[v]) {
+                dist[v] = alt;
+                heapPushOrDecrease(heap, v);
+            }
+        }
+    }
+}
+
+// Function to build the reverse graph (every edge u -> v becomes v -> u)
+// The backward half of a bidirectional search runs on it
+struct CSRGraph* createReverseCSRGraph(const struct CSRGraph* graph) {
+    int* src = (int*)malloc(graph->numEdges * sizeof(int));
+    for (int u = 0; u < graph->numVertices; u++)
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)
+            src[e] = u;
+
+    struct CSRGraph* reverse = createCSRGraph(graph->numVertices, graph->numEdges,
+                                              graph->adj, src, graph->weight);
+    free(src);
+    return reverse;
+}
+
+// Result of a point-to-point query
+struct PathResult {
+    int distance;   // Shortest distance, INT_MAX if target is unreachable
+    int length;     // Number of vertices on the path (0 if unreachable)
+    int* path;      // src ... target, allocated by the query, freed by the caller
+    int settled;    // Vertices extracted from the heap(s) during the search
+};
+
+// Empty the heap after a search that stopped early
+void heapClear(struct MinHeap* heap) {
+    for (int i = 0; i < heap->size; i++)
+        heap->pos[heap->vertex[i]] = -1;
+    heap->size = 0;
+}
+
+// Set the distance and parent of v in the current query and queue it
+void scratchReach(struct SearchScratch* scratch, int v, int distance, int parent) {
+    scratch->stamp[v] = scratch->epoch;
+    scratch->dist[v] = distance;
+    scratch->parent[v] = parent;
+    heapPushOrDecrease(scratch->heap, v);
+}
+
+// Relax every edge leaving u, recording u as parent of every improved vertex
+void scratchRelax(const struct CSRGraph* graph, struct SearchScratch* scratch, int u) {
+    for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+        int v = graph->adj[e];
+        int alt = scratch->dist[u] + graph->weight[e];
+        if (alt < scratchDistance(scratch, v))
+            scratchReach(scratch, v, alt, u);
+    }
+}
+
+// Count the vertices from v back to the root of its search tree
+int treeDepth(const struct SearchScratch* scratch, int v) {
+    int depth = 0;
+    for (; v != -1; v = scratch->parent[v])
+        depth++;
+    return depth;
+}
+
+// Dijkstra from src that stops as soon as target is settled
+// Only vertices closer than target are settled, and with the epoch-stamped
+// scratch space nothing is done for the rest of the graph
+void dijkstraPointToPoint(const struct CSRGraph* graph, int src, int target,
+                          struct SearchScratch* scratch, struct PathResult* result) {
+    result->distance = INT_MAX;
+    result->length = 0;
+    result->path = NULL;
+    result->settled = 0;
+
+    scratchNewQuery(scratch);
+    scratchReach(scratch, src, 0, -1);
+
+    while (scratch->heap->size > 0) {
+        int u = heapExtractMin(scratch->heap);
+        result->settled++;
+        if (u == target)
+            break;
+        scratchRelax(graph, scratch, u);
+    }
+    heapClear(scratch->heap);
+
+    // Walk the parent pointers from target back to src
+    result->distance = scratchDistance(scratch, target);
+    if (result->distance == INT_MAX)
+        return;
+    result->length = treeDepth(scratch, target);
+    result->path = (int*)malloc(result->length * sizeof(int));
+    int i = result->length;
+    for (int v = target; v != -1; v = scratch->parent[v])
+        result->path[--i] = v;
+}
+
+// Bidirectional Dijkstra: a forward search from src on graph and a backward
+// search from target on reverse take turns, always advancing the side whose
+// next vertex is closer. Every scanned edge that reaches a vertex seen by the
+// other side is a candidate path; the best one (best) is final once the two
+// smallest heap keys add up to at least best
+void dijkstraBidirectional(const struct CSRGraph* graph, const struct CSRGraph* reverse,
+                           int src, int target, struct SearchScratch* forward,
+                           struct SearchScratch* backward, struct PathResult* result) {
+    result->distance = INT_MAX;
+    result->length = 0;
+    result->path = NULL;
+    result->settled = 0;
+
+    scratchNewQuery(forward);
+    scratchNewQuery(backward);
+    scratchReach(forward, src, 0, -1);
+    scratchReach(backward, target, 0, -1);
+
+    long best = src == target ? 0 : LONG_MAX;
+    int meetForward = src, meetBackward = target;  // Path is src..meetForward -> meetBackward..target
+
+    while (forward->heap->size > 0 && backward->heap->size > 0) {
+        int topForward = forward->dist[forward->heap->vertex[0]];
+        int topBackward = backward->dist[backward->heap->vertex[0]];
+        if ((long)topForward + topBackward >= best)
+            break;
+
+        // Advance the side with the closer next vertex
+        bool goForward = topForward <= topBackward;
+        struct SearchScratch* self = goForward ? forward : backward;
+        struct SearchScratch* other = goForward ? backward : forward;
+        const struct CSRGraph* g = goForward ? graph : reverse;
+
+        int u = heapExtractMin(self->heap);
+        result->settled++;
+        scratchRelax(g, self, u);
+
+        // Look for a shorter connection through the edges just scanned
+        for (int e = g->rowStart[u]; e < g->rowStart[u + 1]; e++) {
+            int v = g->adj[e];
+            int otherDist = scratchDistance(other, v);
+            if (otherDist == INT_MAX)
+                continue;
+            long candidate = (long)self->dist[u] + g->weight[e] + otherDist;
+            if (candidate < best) {
+                best = candidate;
+                meetForward = goForward ? u : v;
+                meetBackward = goForward ? v : u;
+            }
+        }
+    }
+    heapClear(forward->heap);
+    heapClear(backward->heap);
+
+    if (best == LONG_MAX)
+        return;
+    result->distance = (int)best;
+
+    // src .. meetForward from the forward tree, then meetBackward .. target
+    // from the backward tree (its parents point towards target)
+    int forwardLength = treeDepth(forward, meetForward);
+    int backwardLength = src == target ? 0 : treeDepth(backward, meetBackward);
+    result->length = forwardLength + backwardLength;
+    result->path = (int*)malloc(result->length * sizeof(int));
+    int i = forwardLength;
+    for (int v = meetForward; v != -1; v = forward->parent[v])
+        result->path[--i] = v;
+    i = forwardLength;
+    for (int v = meetBackward; v != -1 && src != target; v = backward->parent[v])
+        result->path[i++] = v;
+}
+
+// Lower bound on the distance from v to target used to guide A*
+// A heuristic is admissible if it never overestimates, and consistent if
+// estimate(u) <= weight(u,v) + estimate(v) for every edge
+struct Heuristic {
+    int (*estimate)(const void* data, int v, int target);
+    const void* data;
+};
+
+// Planar coordinates of every vertex of a geometric graph
+struct Coordinates {
+    int numVertices;
+    double* x;
+    double* y;
+};
+
+// Straight-line distance, admissible when every edge weighs at least its length
+int euclideanHeuristic(const void* data, int v, int target) {
+    const struct Coordinates* coords = (const struct Coordinates*)data;
+    double dx = coords->x[v] - coords->x[target];
+    double dy = coords->y[v] - coords->y[target];
+    return (int)sqrt(dx * dx + dy * dy);
+}
+
+// |dx| + |dy|, admissible on grid-like graphs where edges run along the axes
+int manhattanHeuristic(const void* data, int v, int target) {
+    const struct Coordinates* coords = (const struct Coordinates*)data;
+    return (int)(fabs(coords->x[v] - coords->x[target]) + fabs(coords->y[v] - coords->y[target]));
+}
+
+// Precomputed distances to and from a few landmark vertices (ALT)
+struct Landmarks {
+    int numLandmarks;
+    int numVertices;
+    int* landmark;
+    int* from;  // from[v * numLandmarks + l] = d(landmark l, v)
+    int* to;    // to[v * numLandmarks + l]   = d(v, landmark l)
+};
+
+// Pick landmarks far apart by farthest-point selection: each new landmark is
+// the vertex whose distance to the nearest chosen landmark is largest
+// (vertices no landmark reaches come first). Their distances come from one
+// forward and one backward Dijkstra each
+struct Landmarks* createLandmarks(const struct CSRGraph* graph, const struct CSRGraph* reverse,
+                                  int numLandmarks) {
+    int n = graph->numVertices;
+    if (numLandmarks > n)
+        numLandmarks = n;
+    struct Landmarks* lm = (struct Landmarks*)malloc(sizeof(struct Landmarks));
+    lm->numLandmarks = numLandmarks;
+    lm->numVertices = n;
+    lm->landmark = (int*)malloc(numLandmarks * sizeof(int));
+    lm->from = (int*)malloc((long)numLandmarks * n * sizeof(int));
+    lm->to = (int*)malloc((long)numLandmarks * n * sizeof(int));
+
+    // Distances are stored vertex by vertex so one heuristic call reads one cache line
+    int* from = (int*)malloc(n * sizeof(int));
+    int* to = (int*)malloc(n * sizeof(int));
+    int* minDist = (int*)malloc(n * sizeof(int));  // To the nearest landmark, -1 for landmarks
+    for (int v = 0; v < n; v++)
+        minDist[v] = INT_MAX;
+    int next = 0;
+    for (int l = 0; l < numLandmarks; l++) {
+        lm->landmark[l] = next;
+        dijkstra(graph, next, from, BINARY_HEAP);
+        dijkstra(reverse, next, to, BINARY_HEAP);
+        for (int v = 0; v < n; v++) {
+            lm->from[(long)v * numLandmarks + l] = from[v];
+            lm->to[(long)v * numLandmarks + l] = to[v];
+        }
+
+        // The vertex farthest from all landmarks so far becomes the next one
+        minDist[next] = -1;
+        for (int v = 0; v < n; v++)
+            if (minDist[v] != -1 && from[v] < minDist[v])
+                minDist[v] = from[v];
+        for (int v = 0; v < n; v++)
+            if (minDist[v] > minDist[next])
+                next = v;
+    }
+    free(from);
+    free(to);
+    free(minDist);
+    return lm;
+}
+
+// Check that no vertex was chosen as a landmark twice
+bool distinctLandmarks(const struct Landmarks* lm) {
+    for (int i = 0; i < lm->numLandmarks; i++)
+        for (int j = 0; j < i; j++)
+            if (lm->landmark[i] == lm->landmark[j])
+                return false;
+    return true;
+}
+
+// Function to free landmark tables
+void freeLandmarks(struct Landmarks* lm) {
+    free(lm->landmark);
+    free(lm->from);
+    free(lm->to);
+    free(lm);
+}
+
+// ALT bound from the triangle inequality:
+// d(v,t) >= d(L,t) - d(L,v) and d(v,t) >= d(v,L) - d(t,L) for every landmark L
+int landmarkHeuristic(const void* data, int v, int target) {
+    const struct Landmarks* lm = (const struct Landmarks*)data;
+    const int* fromV = lm->from + (long)v * lm->numLandmarks;
+    const int* fromT = lm->from + (long)target * lm->numLandmarks;
+    const int* toV = lm->to + (long)v * lm->numLandmarks;
+    const int* toT = lm->to + (long)target * lm->numLandmarks;
+    int best = 0;
+    for (int l = 0; l < lm->numLandmarks; l++) {
+        if (fromV[l] != INT_MAX && fromT[l] != INT_MAX && fromT[l] - fromV[l] > best)
+            best = fromT[l] - fromV[l];
+        if (toV[l] != INT_MAX && toT[l] != INT_MAX && toV[l] - toT[l] > best)
+            best = toV[l] - toT[l];
+    }
+    return best;
+}
+
+// A* search from src to target
+// This is Dijkstra on the reduced weights weight(u,v) - h(u) + h(v), so the
+// scratch space and heap are shared with the Dijkstra engine: dist[v] holds
+// the key g(v) + h(v) - h(src) and g(v) is recovered from it. With a consistent
+// heuristic every vertex is settled once; a settled vertex whose key still
+// drops (admissible but inconsistent heuristic) is simply queued again
+void aStarSearch(const struct CSRGraph* graph, int src, int target, struct Heuristic h,
+                 struct SearchScratch* scratch, struct PathResult* result) {
+    result->distance = INT_MAX;
+    result->length = 0;
+    result->path = NULL;
+    result->settled = 0;
+
+    int hSrc = h.estimate(h.data, src, target);
+    scratchNewQuery(scratch);
+    scratchReach(scratch, src, 0, -1);
+
+    while (scratch->heap->size > 0) {
+        int u = heapExtractMin(scratch->heap);
+        result->settled++;
+        if (u == target)
+            break;
+
+        int gU = scratch->dist[u] + hSrc - h.estimate(h.data, u, target);
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            int v = graph->adj[e];
+            int key = gU + graph->weight[e] + h.estimate(h.data, v, target) - hSrc;
+            if (key < scratchDistance(scratch, v))
+                scratchReach(scratch, v, key, u);
+        }
+    }
+    heapClear(scratch->heap);
+
+    // At the target h = 0, so its key is its true distance plus -h(src)
+    if (scratchDistance(scratch, target) == INT_MAX)
+        return;
+    result->distance = scratch->dist[target] + hSrc;
+    result->length = treeDepth(scratch, target);
+    result->path = (int*)malloc(result->length * sizeof(int));
+    int i = result->length;
+    for (int v = target; v != -1; v = scratch->parent[v])
+        result->path[--i] = v;
+}
+
+// Shared state of one batch of queries
+struct BatchJob {
+    const struct CSRGraph* graph;
+    const int* sources;
+    int numSources;
+    const int* targets;   // NULL means every vertex is a target
+    int numTargets;
+    int* result;          // numSources x numTargets, row-major
+    atomic_int nextSource;
+};
+
+// Worker thread: take the next unanswered source until none are left
+void* batchWorker(void* arg) {
+    struct BatchJob* job = (struct BatchJob*)arg;
+    struct SearchScratch* scratch = createSearchScratch(job->graph->numVertices);
+
+    while (true) {
+        int i = atomic_fetch_add(&job->nextSource, 1);
+        if (i >= job->numSources)
+            break;
+
+        dijkstraScratch(job->graph, job->sources[i], scratch);
+
+        int* row = job->result + (long)i * job->numTargets;
+        for (int t = 0; t < job->numTargets; t++)
+            row[t] = scratchDistance(scratch, job->targets ? job->targets[t] : t);
+    }
+
+    freeSearchScratch(scratch);
+    return NULL;
+}
+
+// Answer many shortest path queries against one graph
+// result[i * numTargets + t] receives the distance from sources[i] to targets[t].
+// If targets is NULL, numTargets must be V and every vertex is a target, which
+// gives one full dist[] row per source. Sources are shared out to numThreads
+// threads, each with its own scratch space reused across all of its queries
+void dijkstraBatch(const struct CSRGraph* graph, const int sources[], int numSources,
+                   const int targets[], int numTargets, int result[], int numThreads) {
+    struct BatchJob job;
+    job.graph = graph;
+    job.sources = sources;
+    job.numSources = numSources;
+    job.targets = targets;
+    job.numTargets = numTargets;
+    job.result = result;
+    atomic_init(&job.nextSource, 0);
+
+    if (numThreads > numSources)
+        numThreads = numSources > 0 ? numSources : 1;
+
+    pthread_t* tids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&tids[t], NULL, batchWorker, &job);
+    batchWorker(&job);
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(tids[t], NULL);
+    free(tids);
+}
+
+// Number of online CPUs, used as the default thread count
+int numCPUs() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+// Weighted arc of the graph that is being contracted
+struct Arc {
+    int to;
+    int weight;
+};
+
+// Growable list of arcs
+struct ArcList {
+    struct Arc* arcs;
+    int size;
+    int capacity;
+};
+
+// Add an arc to a list, or lower the weight of an existing arc to the same vertex
+void arcListAddOrLower(struct ArcList* list, int to, int weight) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->arcs[i].to == to) {
+            if (weight < list->arcs[i].weight)
+                list->arcs[i].weight = weight;
+            return;
+        }
+    }
+    if (list->size == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 4;
+        list->arcs = (struct Arc*)realloc(list->arcs, list->capacity * sizeof(struct Arc));
+    }
+    list->arcs[list->size].to = to;
+    list->arcs[list->size].weight = weight;
+    list->size++;
+}
+
+// Remove the arc to vertex to from a list (order is not kept)
+void arcListRemove(struct ArcList* list, int to) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->arcs[i].to == to) {
+            list->arcs[i] = list->arcs[--list->size];
+            return;
+        }
+    }
+}
+
+// Contraction hierarchy: a rank (contraction order) for every vertex and the
+// original edges plus shortcuts split into two upward graphs
+struct ContractionHierarchy {
+    int numVertices;
+    int numShortcuts;
+    int* rank;              // rank[v] = position of v in the contraction order
+    struct CSRGraph* up;    // Edges u -> v with rank[v] > rank[u] (forward search)
+    struct CSRGraph* down;  // Edges v -> u for every u -> v with rank[v] > rank[u] (backward search)
+};
+
+// State of the contraction (preprocessing) phase
+struct CHBuilder {
+    int numVertices;
+    struct ArcList* out;            // Remaining out-arcs of every vertex
+    struct ArcList* in;             // Remaining in-arcs of every vertex
+    bool* contracted;
+    int* deletedNeighbours;         // Contracted neighbours, spreads contraction evenly
+    int* level;                     // 1 + highest level of a contracted neighbour
+    bool* isTarget;                 // Out-neighbours of the vertex being contracted
+    struct SearchScratch* witness;  // Scratch space of the witness searches
+    struct IntVector upEdges;       // (src, dest, weight) triples of the upward graph
+    struct IntVector downEdges;     // (src, dest, weight) triples of the backward graph
+    int numShortcuts;
+};
+
+// Maximum number of vertices a witness search may settle before giving up
+// A failed witness search only adds an unnecessary shortcut, never a wrong
+// one. Priorities are estimated with the same limit as the contraction
+// itself, so the shortcuts they count are the ones that will be added
+#define WITNESS_SETTLE_LIMIT 500
+
+// Neighbours with at most this many remaining arcs get their priority
+// recomputed after each contraction; busier ones (the dense core left at the
+// end) only get the cheap deleted-neighbour and level increments and are
+// recomputed when they reach the top of the queue
+#define EAGER_UPDATE_DEGREE 16
+
+// Dijkstra from src in the remaining graph, skipping vertex avoid, until all
+// numTargets targets, every vertex within maxDist or WITNESS_SETTLE_LIMIT
+// vertices are settled
+void witnessSearch(struct CHBuilder* b, int src, int avoid, int maxDist, int numTargets) {
+    struct SearchScratch* scratch = b->witness;
+    scratchNewQuery(scratch);
+    scratch->stamp[src] = scratch->epoch;
+    scratch->dist[src] = 0;
+    heapPushOrDecrease(scratch->heap, src);
+
+    int settled = 0;
+    while (scratch->heap->size > 0 && settled < WITNESS_SETTLE_LIMIT) {
+        int u = heapExtractMin(scratch->heap);
+        settled++;
+        if (b->isTarget[u] && --numTargets == 0)
+            break;
+        for (int i = 0; i < b->out[u].size; i++) {
+            int v = b->out[u].arcs[i].to;
+            if (v == avoid || b->contracted[v])
+                continue;
+            int alt = scratch->dist[u] + b->out[u].arcs[i].weight;
+            if (alt <= maxDist && alt < scratchDistance(scratch, v)) {
+                scratch->stamp[v] = scratch->epoch;
+                scratch->dist[v] = alt;
+                heapPushOrDecrease(scratch->heap, v);
+            }
+        }
+    }
+    heapClear(scratch->heap);
+}
+
+// Count (and if apply is true, add) the shortcuts needed to contract v:
+// u -> v -> x needs a shortcut u -> x unless a witness path is at most as short
+int contractVertex(struct CHBuilder* b, int v, bool apply) {
+    int shortcuts = 0;
+    struct ArcList* in = &b->in[v];
+    struct ArcList* out = &b->out[v];
+
+    int numTargets = 0;
+    for (int j = 0; j < out->size; j++) {
+        if (!b->contracted[out->arcs[j].to]) {
+            b->isTarget[out->arcs[j].to] = true;
+            numTargets++;
+        }
+    }
+
+    for (int i = 0; i < in->size; i++) {
+        int u = in->arcs[i].to;
+        if (b->contracted[u])
+            continue;
+
+        int maxOut = -1;
+        for (int j = 0; j < out->size; j++)
+            if (!b->contracted[out->arcs[j].to] && out->arcs[j].to != u && out->arcs[j].weight > maxOut)
+                maxOut = out->arcs[j].weight;
+        if (maxOut == -1)
+            continue;
+
+        witnessSearch(b, u, v, in->arcs[i].weight + maxOut, numTargets);
+        for (int j = 0; j < out->size; j++) {
+            int x = out->arcs[j].to;
+            if (b->contracted[x] || x == u)
+                continue;
+            int viaV = in->arcs[i].weight + out->arcs[j].weight;
+            if (scratchDistance(b->witness, x) <= viaV)
+                continue;
+            shortcuts++;
+            if (apply) {
+                arcListAddOrLower(&b->out[u], x, viaV);
+                arcListAddOrLower(&b->in[x], u, viaV);
+            }
+        }
+    }
+
+    for (int j = 0; j < out->size; j++)
+        b->isTarget[out->arcs[j].to] = false;
+    return shortcuts;
+}
+
+// Contraction priority of v: twice the edge difference plus contracted
+// neighbours plus level. Vertices whose removal adds few shortcuts go first;
+// the other two terms spread contraction evenly and keep the hierarchy flat
+int contractionPriority(struct CHBuilder* b, int v) {
+    int removed = 0;
+    for (int i = 0; i < b->out[v].size; i++)
+        if (!b->contracted[b->out[v].arcs[i].to])
+            removed++;
+    for (int i = 0; i < b->in[v].size; i++)
+        if (!b->contracted[b->in[v].arcs[i].to])
+            removed++;
+    return 2 * (contractVertex(b, v, false) - removed) + b->deletedNeighbours[v] + b->level[v];
+}
+
+// Append a (src, dest, weight) triple to an edge vector
+void pushEdgeTriple(struct IntVector* edges, int src, int dest, int weight) {
+    vectorPush(edges, src);
+    vectorPush(edges, dest);
+    vectorPush(edges, weight);
+}
+
+// Function to build a CSR graph from a vector of (src, dest, weight) triples
+struct CSRGraph* createCSRFromTriples(int numVertices, const struct IntVector* edges) {
+    int numEdges = edges->size / 3;
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    int* w = (int*)malloc(numEdges * sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        src[i] = edges->data[3 * i];
+        dest[i] = edges->data[3 * i + 1];
+        w[i] = edges->data[3 * i + 2];
+    }
+    struct CSRGraph* graph = createCSRGraph(numVertices, numEdges, src, dest, w);
+    free(src);
+    free(dest);
+    free(w);
+    return graph;
+}
+
+// Preprocessing: contract the vertices one by one in order of priority
+// (lazy updates: a popped vertex is re-queued if its priority went up)
+struct ContractionHierarchy* buildContractionHierarchy(const struct CSRGraph* graph) {
+    int n = graph->numVertices;
+    struct CHBuilder b;
+    b.numVertices = n;
+    b.out = (struct ArcList*)calloc(n, sizeof(struct ArcList));
+    b.in = (struct ArcList*)calloc(n, sizeof(struct ArcList));
+    b.contracted = (bool*)calloc(n, sizeof(bool));
+    b.deletedNeighbours = (int*)calloc(n, sizeof(int));
+    b.level = (int*)calloc(n, sizeof(int));
+    b.isTarget = (bool*)calloc(n, sizeof(bool));
+    b.witness = createSearchScratch(n);
+    b.upEdges = (struct IntVector){ NULL, 0, 0 };
+    b.downEdges = (struct IntVector){ NULL, 0, 0 };
+    b.numShortcuts = 0;
+
+    // Copy the graph, keeping only the lightest of parallel edges
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            if (graph->adj[e] == u)
+                continue;  // Self loops never lie on a shortest path
+            arcListAddOrLower(&b.out[u], graph->adj[e], graph->weight[e]);
+            arcListAddOrLower(&b.in[graph->adj[e]], u, graph->weight[e]);
+        }
+    }
+
+    struct ContractionHierarchy* ch = (struct ContractionHierarchy*)malloc(sizeof(struct ContractionHierarchy));
+    ch->numVertices = n;
+    ch->rank = (int*)malloc(n * sizeof(int));
+
+    int* priority = (int*)malloc(n * sizeof(int));
+    struct MinHeap* queue = createMinHeap(n, priority);
+    for (int v = 0; v < n; v++) {
+        priority[v] = contractionPriority(&b, v);
+        heapPushOrDecrease(queue, v);
+    }
+
+    int order = 0;
+    while (queue->size > 0) {
+        int v = heapExtractMin(queue);
+        priority[v] = contractionPriority(&b, v);
+        if (queue->size > 0 && priority[v] > priority[queue->vertex[0]]) {
+            heapPushOrDecrease(queue, v);
+            continue;
+        }
+
+        // All remaining neighbours of v will get a higher rank
+        for (int i = 0; i < b.out[v].size; i++)
+            if (!b.contracted[b.out[v].arcs[i].to])
+                pushEdgeTriple(&b.upEdges, v, b.out[v].arcs[i].to, b.out[v].arcs[i].weight);
+        for (int i = 0; i < b.in[v].size; i++)
+            if (!b.contracted[b.in[v].arcs[i].to])
+                pushEdgeTriple(&b.downEdges, v, b.in[v].arcs[i].to, b.in[v].arcs[i].weight);
+
+        b.numShortcuts += contractVertex(&b, v, true);
+        b.contracted[v] = true;
+        ch->rank[v] = order++;
+
+        // Contracting v changes the neighbours' priorities, so update them
+        for (int side = 0; side < 2; side++) {
+            struct ArcList* list = side == 0 ? &b.out[v] : &b.in[v];
+            for (int i = 0; i < list->size; i++) {
+                int x = list->arcs[i].to;
+                if (b.contracted[x])
+                    continue;
+                arcListRemove(side == 0 ? &b.in[x] : &b.out[x], v);
+                b.deletedNeighbours[x]++;
+                int levelIncrease = b.level[x] < b.level[v] + 1 ? b.level[v] + 1 - b.level[x] : 0;
+                b.level[x] += levelIncrease;
+                if (b.in[x].size + b.out[x].size <= EAGER_UPDATE_DEGREE)
+                    priority[x] = contractionPriority(&b, x);
+                else
+                    priority[x] += 1 + levelIncrease;
+                siftUp(queue, queue->pos[x]);
+                siftDown(queue, queue->pos[x]);
+            }
+        }
+
+        free(b.out[v].arcs);
+        free(b.in[v].arcs);
+        b.out[v] = (struct ArcList){ NULL, 0, 0 };
+        b.in[v] = (struct ArcList){ NULL, 0, 0 };
+    }
+
+    ch->numShortcuts = b.numShortcuts;
+    ch->up = createCSRFromTriples(n, &b.upEdges);
+    ch->down = createCSRFromTriples(n, &b.downEdges);
+
+    freeMinHeap(queue);
+    free(priority);
+    free(b.upEdges.data);
+    free(b.downEdges.data);
+    freeSearchScratch(b.witness);
+    free(b.out);
+    free(b.in);
+    free(b.contracted);
+    free(b.deletedNeighbours);
+    free(b.level);
+    free(b.isTarget);
+    return ch;
+}
+
+// Function to free a contraction hierarchy
+void freeContractionHierarchy(struct ContractionHierarchy* ch) {
+    free(ch->rank);
+    freeCSRGraph(ch->up);
+    freeCSRGraph(ch->down);
+    free(ch);
+}
+
+// Write the arrays of a CSR graph to an open file
+bool writeCSRGraph(FILE* file, const struct CSRGraph* graph) {
+    return fwrite(&graph->numEdges, sizeof(int), 1, file) == 1
+        && fwrite(graph->rowStart, sizeof(int), graph->numVertices + 1, file) == (size_t)graph->numVertices + 1
+        && fwrite(graph->adj, sizeof(int), graph->numEdges, file) == (size_t)graph->numEdges
+        && fwrite(graph->weight, sizeof(int), graph->numEdges, file) == (size_t)graph->numEdges;
+}
+
+// Read a CSR graph written by writeCSRGraph() (NULL on a short or bad file)
+// A file cannot hold more than maxEdges edges, so a corrupt count is caught
+// before anything is allocated; the arrays are then checked like a graph file
+struct CSRGraph* readCSRGraph(FILE* file, int numVertices, long maxEdges) {
+    int numEdges;
+    if (fread(&numEdges, sizeof(int), 1, file) != 1 || numEdges < 0 || numEdges > maxEdges)
+        return NULL;
+    struct CSRGraph* graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    graph->numVertices = numVertices;
+    graph->numEdges = numEdges;
+    graph->rowStart = (int*)malloc((numVertices + 1) * sizeof(int));
+    graph->adj = (int*)malloc(numEdges * sizeof(int));
+    graph->weight = (int*)malloc(numEdges * sizeof(int));
+    if (fread(graph->rowStart, sizeof(int), numVertices + 1, file) != (size_t)numVertices + 1
+        || fread(graph->adj, sizeof(int), numEdges, file) != (size_t)numEdges
+        || fread(graph->weight, sizeof(int), numEdges, file) != (size_t)numEdges
+        || !verifyCSRArrays(numVertices, numEdges, graph->rowStart, graph->adj)) {
+        freeCSRGraph(graph);
+        return NULL;
+    }
+    for (int e = 0; e < numEdges; e++) {
+        if (graph->weight[e] < 0) {
+            freeCSRGraph(graph);
+            return NULL;
+        }
+    }
+    return graph;
+}
+
+// Check that rank[] is a permutation and every edge of the upward graph leads
+// to a higher rank, so chQuery() can trust a loaded index
+bool verifyHierarchy(const struct ContractionHierarchy* ch, const struct CSRGraph* graph) {
+    for (int u = 0; u < ch->numVertices; u++)
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)
+            if (ch->rank[graph->adj[e]] <= ch->rank[u])
+                return false;
+    return true;
+}
+
+// Magic number at the start of a contraction hierarchy file ("CH01")
+#define CH_FILE_MAGIC 0x31304843
+
+// Save a contraction hierarchy: magic, V, shortcuts, rank[], up graph, down graph
+bool saveContractionHierarchy(const struct ContractionHierarchy* ch, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Cannot open %s for writing\n", path);
+        return false;
+    }
+    int header[3] = { CH_FILE_MAGIC, ch->numVertices, ch->numShortcuts };
+    bool ok = fwrite(header, sizeof(int), 3, file) == 3
+        && fwrite(ch->rank, sizeof(int), ch->numVertices, file) == (size_t)ch->numVertices
+        && writeCSRGraph(file, ch->up)
+        && writeCSRGraph(file, ch->down);
+    if (fclose(file) != 0 || !ok) {
+        printf("Error writing %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Load a contraction hierarchy saved by saveContractionHierarchy()
+// Every count, offset, target and rank is checked before it is used, so a
+// truncated or corrupt file is reported instead of crashing a later query
+struct ContractionHierarchy* loadContractionHierarchy(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Cannot open %s\n", path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long maxInts = ftell(file) / (long)sizeof(int);
+    rewind(file);
+
+    int header[3];
+    if (fread(header, sizeof(int), 3, file) != 3 || header[0] != CH_FILE_MAGIC || header[1] < 1
+        || header[1] > maxInts || header[2] < 0) {
+        printf("%s is not a contraction hierarchy file\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    struct ContractionHierarchy* ch = (struct ContractionHierarchy*)malloc(sizeof(struct ContractionHierarchy));
+    ch->numVertices = header[1];
+    ch->numShortcuts = header[2];
+    ch->rank = (int*)malloc(ch->numVertices * sizeof(int));
+    bool ok = fread(ch->rank, sizeof(int), ch->numVertices, file) == (size_t)ch->numVertices;
+
+    // rank[] must be a permutation of 0 .. V-1
+    bool* seen = (bool*)calloc(ch->numVertices, sizeof(bool));
+    for (int v = 0; ok && v < ch->numVertices; v++) {
+        int r = ch->rank[v];
+        ok = r >= 0 && r < ch->numVertices && !seen[r];
+        if (ok)
+            seen[r] = true;
+    }
+    free(seen);
+
+    // Each edge needs two ints (target, weight), which bounds the edge counts
+    long maxEdges = maxInts / 2;
+    ch->up = ok ? readCSRGraph(file, ch->numVertices, maxEdges) : NULL;
+    ch->down = ch->up ? readCSRGraph(file, ch->numVertices, maxEdges) : NULL;
+    fclose(file);
+
+    if (ch->down == NULL || !verifyHierarchy(ch, ch->up) || !verifyHierarchy(ch, ch->down)) {
+        printf("%s is truncated or corrupt\n", path);
+        if (ch->up)
+            freeCSRGraph(ch->up);
+        if (ch->down)
+            freeCSRGraph(ch->down);
+        free(ch->rank);
+        free(ch);
+        return NULL;
+    }
+    return ch;
+}
+
+// Shortest distance from src to target on a contraction hierarchy
+// Both searches only go upwards in rank, so they settle very few vertices;
+// the shortest path is the best vertex reached by both. A side stops once
+// its smallest key is no better than the best distance found so far
+int chQuery(const struct ContractionHierarchy* ch, int src, int target,
+            struct SearchScratch* forward, struct SearchScratch* backward, int* settled) {
+    scratchNewQuery(forward);
+    scratchNewQuery(backward);
+    scratchReach(forward, src, 0, -1);
+    scratchReach(backward, target, 0, -1);
+
+    long best = LONG_MAX;
+    *settled = 0;
+    while (true) {
+        bool forwardDone = forward->heap->size == 0
+            || forward->dist[forward->heap->vertex[0]] >= best;
+        bool backwardDone = backward->heap->size == 0
+            || backward->dist[backward->heap->vertex[0]] >= best;
+        if (forwardDone && backwardDone)
+            break;
+
+        bool goForward = !forwardDone && (backwardDone
+            || forward->dist[forward->heap->vertex[0]] <= backward->dist[backward->heap->vertex[0]]);
+        struct SearchScratch* self = goForward ? forward : backward;
+        struct SearchScratch* other = goForward ? backward : forward;
+
+        int u = heapExtractMin(self->heap);
+        (*settled)++;
+        int otherDist = scratchDistance(other, u);
+        if (otherDist != INT_MAX && (long)self->dist[u] + otherDist < best)
+            best = (long)self->dist[u] + otherDist;
+        scratchRelax(goForward ? ch->up : ch->down, self, u);
+    }
+    heapClear(forward->heap);
+    heapClear(backward->heap);
+
+    return best == LONG_MAX ? INT_MAX : (int)best;
+}
+
+// Shortest path tree from one source that is repaired after weight changes
+// The graph weights are changed in place; in-edges are kept as forward edge
+// indices so the reverse adjacency never needs updating
+struct DynamicSSSP {
+    struct CSRGraph* graph;
+    int src;
+    int* dist;
+    int* parentEdge;     // Edge index of the tree edge into v, -1 for src or unreached
+    int* edgeSource;     // edgeSource[e] = tail vertex of edge e
+    int* inRowStart;     // inEdge[inRowStart[v] .. inRowStart[v+1]-1] enter v
+    int* inEdge;
+    int* affected;       // affected[v] == affectedEpoch while v is being repaired
+    int affectedEpoch;
+    struct IntVector work;
+    struct MinHeap* heap;
+};
+
+// Run Dijkstra from whatever is in the heap, only touching improved vertices
+void dynamicPropagate(struct DynamicSSSP* ds) {
+    const struct CSRGraph* graph = ds->graph;
+    while (ds->heap->size > 0) {
+        int u = heapExtractMin(ds->heap);
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            int v = graph->adj[e];
+            int alt = ds->dist[u] + graph->weight[e];
+            if (alt < ds->dist[v]) {
+                ds->dist[v] = alt;
+                ds->parentEdge[v] = e;
+                heapPushOrDecrease(ds->heap, v);
+            }
         }
     }
-    
-    return min_index;
 }
 
-// Function to print the constructed distance array
-void printSolution(int dist[]) {
-    printf("Vertex \t\t Distance from Source\n");
-    for (int i = 0; i < V; i++)
-        printf("%d \t\t %d\n", i, dist[i]);
+// Function to compute the initial tree and the in-edge index of a graph
+struct DynamicSSSP* createDynamicSSSP(struct CSRGraph* graph, int src) {
+    int n = graph->numVertices;
+    struct DynamicSSSP* ds = (struct DynamicSSSP*)malloc(sizeof(struct DynamicSSSP));
+    ds->graph = graph;
+    ds->src = src;
+    ds->dist = (int*)malloc(n * sizeof(int));
+    ds->parentEdge = (int*)malloc(n * sizeof(int));
+    ds->edgeSource = (int*)malloc(graph->numEdges * sizeof(int));
+    ds->inRowStart = (int*)calloc(n + 1, sizeof(int));
+    ds->inEdge = (int*)malloc(graph->numEdges * sizeof(int));
+    ds->affected = (int*)calloc(n, sizeof(int));
+    ds->affectedEpoch = 0;
+    ds->work = (struct IntVector){ NULL, 0, 0 };
+    ds->heap = createMinHeap(n, ds->dist);
+
+    // Bucket the edges by head vertex, as in createCSRGraph()
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            ds->edgeSource[e] = u;
+            ds->inRowStart[graph->adj[e] + 1]++;
+        }
+    }
+    for (int v = 0; v < n; v++)
+        ds->inRowStart[v + 1] += ds->inRowStart[v];
+    int* next = (int*)malloc(n * sizeof(int));
+    memcpy(next, ds->inRowStart, n * sizeof(int));
+    for (int e = 0; e < graph->numEdges; e++)
+        ds->inEdge[next[graph->adj[e]]++] = e;
+    free(next);
+
+    for (int v = 0; v < n; v++) {
+        ds->dist[v] = INT_MAX;
+        ds->parentEdge[v] = -1;
+    }
+    ds->dist[src] = 0;
+    heapPushOrDecrease(ds->heap, src);
+    dynamicPropagate(ds);
+    return ds;
 }
 
-// Function to implement Dijkstra's single source shortest path algorithm
-// graph[i][j] represents the weight of edge from i to j (0 means no edge)
-void dijkstra(int graph[V][V], int src) {
-    int dist[V];      // dist[i] will hold the shortest distance from src to i
-    bool sptSet[V];   // sptSet[i] will be true if vertex i is included in shortest path tree
-    
-    // Initialize all distances as INFINITE and sptSet[] as false
-    for (int i = 0; i < V; i++) {
+// Function to free a dynamic shortest path tree (the graph is not freed)
+void freeDynamicSSSP(struct DynamicSSSP* ds) {
+    free(ds->dist);
+    free(ds->parentEdge);
+    free(ds->edgeSource);
+    free(ds->inRowStart);
+    free(ds->inEdge);
+    free(ds->affected);
+    free(ds->work.data);
+    freeMinHeap(ds->heap);
+    free(ds);
+}
+
+// Find the index of the edge u -> v (the lightest one if there are several), -1 if none
+int findEdge(const struct CSRGraph* graph, int u, int v) {
+    int best = -1;
+    for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)
+        if (graph->adj[e] == v && (best == -1 || graph->weight[e] < graph->weight[best]))
+            best = e;
+    return best;
+}
+
+// Change the weight of edge e and repair dist[] and the tree
+// Cheaper edge: only vertices that get closer through it are revisited.
+// Dearer tree edge: the subtree below it loses its distances; each of its
+// vertices restarts from its best in-edge from outside the subtree, and
+// Dijkstra restricted to the subtree settles the rest.
+// Dearer non-tree edge: nothing changes
+void dynamicUpdateEdge(struct DynamicSSSP* ds, int e, int newWeight) {
+    struct CSRGraph* graph = ds->graph;
+    int u = ds->edgeSource[e];
+    int v = graph->adj[e];
+    int oldWeight = graph->weight[e];
+    graph->weight[e] = newWeight;
+
+    if (newWeight <= oldWeight) {
+        if (ds->dist[u] != INT_MAX && ds->dist[u] + newWeight < ds->dist[v]) {
+            ds->dist[v] = ds->dist[u] + newWeight;
+            ds->parentEdge[v] = e;
+            heapPushOrDecrease(ds->heap, v);
+            dynamicPropagate(ds);
+        }
+        return;
+    }
+    if (ds->parentEdge[v] != e)
+        return;
+
+    // Collect the subtree hanging from edge e
+    if (++ds->affectedEpoch == INT_MAX) {
+        memset(ds->affected, 0, graph->numVertices * sizeof(int));
+        ds->affectedEpoch = 1;
+    }
+    int epoch = ds->affectedEpoch;
+    struct IntVector* work = &ds->work;
+    work->size = 0;
+    vectorPush(work, v);
+    ds->affected[v] = epoch;
+    for (int i = 0; i < work->size; i++) {
+        int x = work->data[i];
+        for (int f = graph->rowStart[x]; f < graph->rowStart[x + 1]; f++) {
+            int y = graph->adj[f];
+            if (ds->parentEdge[y] == f && ds->affected[y] != epoch) {
+                ds->affected[y] = epoch;
+                vectorPush(work, y);
+            }
+        }
+    }
+
+    // Restart every affected vertex from its best unaffected in-neighbour
+    for (int i = 0; i < work->size; i++) {
+        int x = work->data[i];
+        ds->dist[x] = INT_MAX;
+        ds->parentEdge[x] = -1;
+        for (int k = ds->inRowStart[x]; k < ds->inRowStart[x + 1]; k++) {
+            int f = ds->inEdge[k];
+            int p = ds->edgeSource[f];
+            if (ds->affected[p] == epoch || ds->dist[p] == INT_MAX)
+                continue;
+            if (ds->dist[p] + graph->weight[f] < ds->dist[x]) {
+                ds->dist[x] = ds->dist[p] + graph->weight[f];
+                ds->parentEdge[x] = f;
+            }
+        }
+        if (ds->dist[x] != INT_MAX)
+            heapPushOrDecrease(ds->heap, x);
+    }
+    dynamicPropagate(ds);
+}
+
+// Typed shortest path kernels
+// DEFINE_SHORTEST_PATH_KERNEL generates a CSR graph type, an indexed heap and
+// a binary-heap Dijkstra for one weight type, so every instantiation is
+// compiled with its own types and comparisons and nothing is dispatched at
+// run time inside the relaxation loop. DIST_T may be wider than WEIGHT_T
+// (uint32 weights are summed in 64 bits).
+// Overflow: a sum that wraps around (unsigned types: smaller than dist[u])
+// or reaches DIST_INF (float types: rounds to infinity) is never stored, so
+// no distance is ever wrong. A vertex whose distance does not fit is left at
+// DIST_INF like an unreachable one, and the kernel returns false so callers
+// can tell the two apart.
+#define DEFINE_SHORTEST_PATH_KERNEL(SUFFIX, WEIGHT_T, DIST_T, DIST_INF)                    \
+                                                                                           \
+struct CSRGraph##SUFFIX {                                                                  \
+    int numVertices;                                                                       \
+    int numEdges;                                                                          \
+    int* rowStart;                                                                         \
+    int* adj;                                                                              \
+    WEIGHT_T* weight;                                                                      \
+};                                                                                         \
+                                                                                           \
+/* Copy the structure of an int CSR graph, converting every weight with convert() */      \
+struct CSRGraph##SUFFIX* createCSRGraph##SUFFIX(const struct CSRGraph* graph,              \
+                                                WEIGHT_T (*convert)(int)) {                \
+    struct CSRGraph##SUFFIX* typed =                                                       \
+        (struct CSRGraph##SUFFIX*)malloc(sizeof(struct CSRGraph##SUFFIX));                 \
+    typed->numVertices = graph->numVertices;                                               \
+    typed->numEdges = graph->numEdges;                                                     \
+    typed->rowStart = (int*)malloc((graph->numVertices + 1) * sizeof(int));                \
+    typed->adj = (int*)malloc(graph->numEdges * sizeof(int));                              \
+    typed->weight = (WEIGHT_T*)malloc(graph->numEdges * sizeof(WEIGHT_T));                 \
+    memcpy(typed->rowStart, graph->rowStart, (graph->numVertices + 1) * sizeof(int));      \
+    memcpy(typed->adj, graph->adj, graph->numEdges * sizeof(int));                         \
+    for (int e = 0; e < graph->numEdges; e++)                                              \
+        typed->weight[e] = convert(graph->weight[e]);                                      \
+    return typed;                                                                          \
+}                                                                                          \
+                                                                                           \
+void freeCSRGraph##SUFFIX(struct CSRGraph##SUFFIX* graph) {                                \
+    free(graph->rowStart);                                                                 \
+    free(graph->adj);                                                                      \
+    free(graph->weight);                                                                   \
+    free(graph);                                                                           \
+}                                                                                          \
+                                                                                           \
+DEFINE_INDEXED_HEAP(SUFFIX, DIST_T)                                                        \
+                                                                                           \
+/* dist[i] receives the distance from src to i, DIST_INF if i is unreachable */           \
+/* or its distance does not fit below DIST_INF; returns false in that case */             \
+bool dijkstra##SUFFIX(const struct CSRGraph##SUFFIX* graph, int src, DIST_T dist[]) {      \
+    int n = graph->numVertices;                                                            \
+    struct MinHeap##SUFFIX* heap = createMinHeap##SUFFIX(n, dist);                         \
+    for (int v = 0; v < n; v++)                                                            \
+        dist[v] = DIST_INF;                                                                \
+                                                                                           \
+    bool wrapped = false;                                                                  \
+    dist[src] = 0;                                                                         \
+    heapPushOrDecrease##SUFFIX(heap, src);                                                 \
+    while (heap->size > 0) {                                                               \
+        int u = heapExtractMin##SUFFIX(heap);                                              \
+        DIST_T du = dist[u];                                                               \
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {                \
+            int v = graph->adj[e];                                                         \
+            DIST_T alt = du + (DIST_T)graph->weight[e];                                    \
+            if (alt < du || alt == DIST_INF) {                                             \
+                wrapped = true;  /* Wrapped around or reached the sentinel */             \
+                continue;                                                                  \
+            }                                                                              \
+            if (alt < dist[v]) {                                                           \
+                dist[v] = alt;                                                             \
+                heapPushOrDecrease##SUFFIX(heap, v);                                       \
+            }                                                                              \
+        }                                                                                  \
+    }                                                                                      \
+                                                                                           \
+    /* A skipped sum only matters if its target was never reached by a path */            \
+    /* that fits: then some edge leads from a reached vertex to a DIST_INF one */         \
+    bool fits = true;                                                                      \
+    for (int u = 0; wrapped && fits && u < n; u++)                                         \
+        if (dist[u] != DIST_INF)                                                           \
+            for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)              \
+                if (dist[graph->adj[e]] == DIST_INF)                                       \
+                    fits = false;                                                          \
+                                                                                           \
+    freeMinHeap##SUFFIX(heap);                                                             \
+    return fits;                                                                           \
+}
+
+DEFINE_SHORTEST_PATH_KERNEL(U32, uint32_t, uint64_t, UINT64_MAX)
+DEFINE_SHORTEST_PATH_KERNEL(U64, uint64_t, uint64_t, UINT64_MAX)
+DEFINE_SHORTEST_PATH_KERNEL(F32, float, float, INFINITY)
+DEFINE_SHORTEST_PATH_KERNEL(F64, double, double, INFINITY)
+
+// Pick the kernel matching the graph's weight type at compile time
+#define dijkstraTyped(graph, src, dist) _Generic((graph),                                  \
+    struct CSRGraphU32*: dijkstraU32,                                                      \
+    struct CSRGraphU64*: dijkstraU64,                                                      \
+    struct CSRGraphF32*: dijkstraF32,                                                      \
+    struct CSRGraphF64*: dijkstraF64)(graph, src, dist)
+
+// Weight conversions used to build typed graphs from the int CSR graph
+uint32_t weightToU32(int w) { return (uint32_t)w; }
+uint64_t weightToU64(int w) { return (uint64_t)w; }
+float weightToF32(int w) { return (float)w; }
+double weightToF64(int w) { return (double)w; }
+
+// Reference O(V^2) implementation on an n x n row-major adjacency matrix
+// matrix[i*n + j] is the weight of edge i -> j (0 means no edge)
+void dijkstraMatrix(int n, const int matrix[], int src, int dist[]) {
+    bool* sptSet = (bool*)malloc(n * sizeof(bool));  // true once a vertex is settled
+
+    for (int i = 0; i < n; i++) {
         dist[i] = INT_MAX;
         sptSet[i] = false;
     }
-    
-    // Distance of source vertex from itself is always 0
     dist[src] = 0;
-    
-    // Find shortest path for all vertices
-    for (int count = 0; count < V - 1; count++) {
-        // Pick the minimum distance vertex from the set of vertices not yet processed
-        int u = minDistance(dist, sptSet);
-        
-        // Mark the picked vertex as processed
+
+    for (int count = 0; count < n - 1; count++) {
+        // Pick the minimum distance vertex not yet processed
+        int min = INT_MAX, u = -1;
+        for (int v = 0; v < n; v++) {
+            if (!sptSet[v] && dist[v] < min) {
+                min = dist[v];
+                u = v;
+            }
+        }
+        if (u == -1)
+            break;  // Remaining vertices are unreachable
         sptSet[u] = true;
-        
-        // Update dist value of the adjacent vertices of the picked vertex
-        for (int v = 0; v < V; v++) {
-            // Update dist[v] only if:
-            // - it is not in sptSet
-            // - there is an edge from u to v
-            // - total weight of path from src to v through u is smaller than current value of dist[v]
-            if (!sptSet[v] && graph[u][v] && dist[u] != INT_MAX 
-                && dist[u] + graph[u][v] < dist[v]) {
-                dist[v] = dist[u] + graph[u][v];
+
+        for (int v = 0; v < n; v++) {
+            int w = matrix[u * n + v];
+            if (!sptSet[v] && w && dist[u] + w < dist[v])
+                dist[v] = dist[u] + w;
+        }
+    }
+
+    free(sptSet);
+}
+
+// Function to print the constructed distance array
+void printSolution(int dist[], int n) {
+    printf("Vertex \t\t Distance from Source\n");
+    for (int i = 0; i < n; i++) {
+        if (dist[i] == INT_MAX)
+            printf("%d \t\t INF\n", i);
+        else
+            printf("%d \t\t %d\n", i, dist[i]);
+    }
+}
+
+// Compare the CSR result against the matrix reference on a random graph
+bool checkAgainstMatrix(int n, int density, unsigned int seed, enum QueueType queue) {
+    int* matrix = (int*)calloc(n * n, sizeof(int));
+    srand(seed);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            if (i != j && rand() % 100 < density)
+                matrix[i * n + j] = 1 + rand() % 100;
+
+    struct CSRGraph* graph = createCSRFromMatrix(n, matrix);
+    int* expected = (int*)malloc(n * sizeof(int));
+    int* actual = (int*)malloc(n * sizeof(int));
+    bool ok = true;
+
+    for (int src = 0; src < n && ok; src++) {
+        dijkstraMatrix(n, matrix, src, expected);
+        dijkstra(graph, src, actual, queue);
+        for (int v = 0; v < n; v++)
+            if (expected[v] != actual[v])
+                ok = false;
+    }
+
+    free(matrix);
+    free(expected);
+    free(actual);
+    freeCSRGraph(graph);
+    return ok;
+}
+
+// Simple xorshift generator so benchmark graphs are fast to build and reproducible
+unsigned int xorshift32(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Function to build a random road-like graph: a ring (so every vertex is
+// reachable) plus random edges, with weights in 1..maxWeight
+struct CSRGraph* createRandomGraph(int numVertices, int numEdges, int maxWeight, unsigned int seed) {
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    int* w = (int*)malloc(numEdges * sizeof(int));
+    unsigned int state = seed ? seed : 1;
+
+    for (int i = 0; i < numEdges; i++) {
+        if (i < numVertices) {
+            src[i] = i;
+            dest[i] = (i + 1) % numVertices;
+        } else {
+            src[i] = xorshift32(&state) % numVertices;
+            dest[i] = xorshift32(&state) % numVertices;
+        }
+        w[i] = 1 + xorshift32(&state) % maxWeight;
+    }
+
+    struct CSRGraph* graph = createCSRGraph(numVertices, numEdges, src, dest, w);
+    free(src);
+    free(dest);
+    free(w);
+    return graph;
+}
+
+// Wall-clock time in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Benchmark both priority queues and delta-stepping on one random graph
+void benchmark(int numVertices, int numEdges, int maxWeight, int delta, int maxThreads) {
+    printf("Benchmark: V = %d, E = %d, weights 1..%d\n", numVertices, numEdges, maxWeight);
+    struct CSRGraph* graph = createRandomGraph(numVertices, numEdges, maxWeight, 12345);
+    int* heapDist = (int*)malloc(numVertices * sizeof(int));
+    int* dialDist = (int*)malloc(numVertices * sizeof(int));
+
+    double start = nowSeconds();
+    dijkstra(graph, 0, heapDist, BINARY_HEAP);
+    double heapTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    dijkstra(graph, 0, dialDist, DIAL_BUCKETS);
+    double dialTime = nowSeconds() - start;
+
+    bool same = memcmp(heapDist, dialDist, numVertices * sizeof(int)) == 0;
+    printf("%-6s %10.3f s\n", queueName(BINARY_HEAP), heapTime);
+    printf("%-6s %10.3f s\n", queueName(DIAL_BUCKETS), dialTime);
+    printf("Speedup: %.2fx, distances %s\n", heapTime / dialTime, same ? "match" : "DIFFER");
+
+    // Delta-stepping with 1, 2, 4, ... threads up to maxThreads
+    printf("\nDelta-stepping, delta = %d\n", delta);
+    printf("Threads       Time    vs heap\n");
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > maxThreads)
+            threads = maxThreads;
+        start = nowSeconds();
+        dijkstraDeltaStepping(graph, 0, dialDist, delta, threads);
+        double deltaTime = nowSeconds() - start;
+        same = memcmp(heapDist, dialDist, numVertices * sizeof(int)) == 0;
+        printf("%7d %8.3f s %8.2fx %s\n", threads, deltaTime, heapTime / deltaTime,
+               same ? "" : "DISTANCES DIFFER");
+        if (threads == maxThreads)
+            break;
+    }
+
+    free(heapDist);
+    free(dialDist);
+    freeCSRGraph(graph);
+}
+
+// Compare one dijkstra() call per source with the batch API
+void benchmarkBatch(int numVertices, int numEdges, int numSources, int maxThreads) {
+    printf("Batch benchmark: V = %d, E = %d, %d sources\n", numVertices, numEdges, numSources);
+    struct CSRGraph* graph = createRandomGraph(numVertices, numEdges, 255, 12345);
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    unsigned int state = 99;
+    for (int i = 0; i < numSources; i++)
+        sources[i] = xorshift32(&state) % numVertices;
+
+    // Many-to-many: distances to the first 16 sources only
+    // Sizes are computed in size_t, numSources * numTargets may not fit in an int
+    int numTargets = numSources < 16 ? numSources : 16;
+    size_t matrixBytes = (size_t)numSources * numTargets * sizeof(int);
+    int* expected = (int*)malloc(matrixBytes);
+    int* actual = (int*)malloc(matrixBytes);
+    int* dist = (int*)malloc(numVertices * sizeof(int));
+
+    double start = nowSeconds();
+    for (int i = 0; i < numSources; i++) {
+        dijkstra(graph, sources[i], dist, BINARY_HEAP);
+        for (int t = 0; t < numTargets; t++)
+            expected[(size_t)i * numTargets + t] = dist[sources[t]];
+    }
+    double singleTime = nowSeconds() - start;
+    printf("one call per source %8.3f s\n", singleTime);
+
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > maxThreads)
+            threads = maxThreads;
+        start = nowSeconds();
+        dijkstraBatch(graph, sources, numSources, sources, numTargets, actual, threads);
+        double batchTime = nowSeconds() - start;
+        bool same = memcmp(expected, actual, matrixBytes) == 0;
+        printf("batch, %2d threads   %8.3f s %8.2fx %s\n", threads, batchTime,
+               singleTime / batchTime, same ? "" : "DISTANCES DIFFER");
+        if (threads == maxThreads)
+            break;
+    }
+
+    free(sources);
+    free(expected);
+    free(actual);
+    free(dist);
+    freeCSRGraph(graph);
+}
+
+// Weight of the path returned by a query, -1 if it is not a path of the graph
+long pathWeight(const struct CSRGraph* graph, const struct PathResult* result) {
+    long total = 0;
+    for (int i = 0; i + 1 < result->length; i++) {
+        int u = result->path[i], v = result->path[i + 1];
+        int best = INT_MAX;
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++)
+            if (graph->adj[e] == v && graph->weight[e] < best)
+                best = graph->weight[e];
+        if (best == INT_MAX)
+            return -1;
+        total += best;
+    }
+    return total;
+}
+
+// Print a path found by a point-to-point query
+void printPath(const char* name, const struct PathResult* result) {
+    printf("%-14s distance %d, settled %d, path:", name, result->distance, result->settled);
+    for (int i = 0; i < result->length; i++)
+        printf(" %d", result->path[i]);
+    printf("\n");
+}
+
+// Compare full, early-exit and bidirectional searches on random pairs
+void benchmarkPointToPoint(int numVertices, int numEdges, int numQueries) {
+    printf("Point-to-point benchmark: V = %d, E = %d, %d queries\n", numVertices, numEdges, numQueries);
+    struct CSRGraph* graph = createRandomGraph(numVertices, numEdges, 255, 12345);
+    struct CSRGraph* reverse = createReverseCSRGraph(graph);
+    struct SearchScratch* forward = createSearchScratch(numVertices);
+    struct SearchScratch* backward = createSearchScratch(numVertices);
+    int* dist = (int*)malloc(numVertices * sizeof(int));
+    double fullTime = 0, p2pTime = 0, bidirTime = 0;
+    long p2pSettled = 0, bidirSettled = 0;
+    int mismatches = 0;
+    unsigned int state = 77;
+
+    for (int q = 0; q < numQueries; q++) {
+        int src = xorshift32(&state) % numVertices;
+        int target = xorshift32(&state) % numVertices;
+        struct PathResult p2p, bidir;
+
+        double start = nowSeconds();
+        dijkstra(graph, src, dist, BINARY_HEAP);
+        fullTime += nowSeconds() - start;
+
+        start = nowSeconds();
+        dijkstraPointToPoint(graph, src, target, forward, &p2p);
+        p2pTime += nowSeconds() - start;
+
+        start = nowSeconds();
+        dijkstraBidirectional(graph, reverse, src, target, forward, backward, &bidir);
+        bidirTime += nowSeconds() - start;
+
+        p2pSettled += p2p.settled;
+        bidirSettled += bidir.settled;
+        if (p2p.distance != dist[target] || bidir.distance != dist[target]
+            || pathWeight(graph, &p2p) != dist[target] || pathWeight(graph, &bidir) != dist[target])
+            mismatches++;
+        free(p2p.path);
+        free(bidir.path);
+    }
+
+    printf("Search          Avg time   Avg settled\n");
+    printf("full          %8.3f ms %12d\n", 1000 * fullTime / numQueries, numVertices);
+    printf("early exit    %8.3f ms %12ld\n", 1000 * p2pTime / numQueries, p2pSettled / numQueries);
+    printf("bidirectional %8.3f ms %12ld\n", 1000 * bidirTime / numQueries, bidirSettled / numQueries);
+    printf("Paths %s\n", mismatches == 0 ? "match full Dijkstra" : "DIFFER from full Dijkstra");
+
+    free(dist);
+    freeSearchScratch(forward);
+    freeSearchScratch(backward);
+    freeCSRGraph(reverse);
+    freeCSRGraph(graph);
+}
+
+// Function to build a width x height grid graph with edges to the 4 neighbours
+// Vertex (x, y) sits at coordinates (10x, 10y) (stored if coords is not
+// NULL); every edge weighs 10..30 so the Euclidean and Manhattan heuristics
+// are admissible
+struct CSRGraph* createGridGraph(int width, int height, unsigned int seed, struct Coordinates* coords) {
+    int n = width * height;
+    int maxEdges = 4 * n;
+    int* src = (int*)malloc(maxEdges * sizeof(int));
+    int* dest = (int*)malloc(maxEdges * sizeof(int));
+    int* w = (int*)malloc(maxEdges * sizeof(int));
+    unsigned int state = seed ? seed : 1;
+    int numEdges = 0;
+
+    if (coords) {
+        coords->numVertices = n;
+        coords->x = (double*)malloc(n * sizeof(double));
+        coords->y = (double*)malloc(n * sizeof(double));
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int v = y * width + x;
+            if (coords) {
+                coords->x[v] = 10.0 * x;
+                coords->y[v] = 10.0 * y;
+            }
+
+            // Add both directions of the edges to the right and downwards
+            int neighbours[2] = { x + 1 < width ? v + 1 : -1, y + 1 < height ? v + width : -1 };
+            for (int k = 0; k < 2; k++) {
+                if (neighbours[k] == -1)
+                    continue;
+                int weight = 10 + xorshift32(&state) % 21;
+                src[numEdges] = v; dest[numEdges] = neighbours[k]; w[numEdges++] = weight;
+                src[numEdges] = neighbours[k]; dest[numEdges] = v; w[numEdges++] = weight;
+            }
+        }
+    }
+
+    struct CSRGraph* graph = createCSRGraph(n, numEdges, src, dest, w);
+    free(src);
+    free(dest);
+    free(w);
+    return graph;
+}
+
+// Function to build a width x height grid shaped like a road network: every
+// 8th row and column is an arterial road (weights 10..14) and every 64th a
+// highway (4..6), the rest are local streets (20..40). Unlike a grid with
+// uniform weights it has the hierarchy contraction hierarchies rely on
+struct CSRGraph* createRoadGraph(int width, int height, unsigned int seed) {
+    int n = width * height;
+    int maxEdges = 4 * n;
+    int* src = (int*)malloc(maxEdges * sizeof(int));
+    int* dest = (int*)malloc(maxEdges * sizeof(int));
+    int* w = (int*)malloc(maxEdges * sizeof(int));
+    unsigned int state = seed ? seed : 1;
+    int numEdges = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int v = y * width + x;
+            // The edge to the right runs along row y, the one downwards along column x
+            int neighbours[2] = { x + 1 < width ? v + 1 : -1, y + 1 < height ? v + width : -1 };
+            int line[2] = { y, x };
+            for (int k = 0; k < 2; k++) {
+                if (neighbours[k] == -1)
+                    continue;
+                int weight;
+                if (line[k] % 64 == 0)
+                    weight = 4 + xorshift32(&state) % 3;
+                else if (line[k] % 8 == 0)
+                    weight = 10 + xorshift32(&state) % 5;
+                else
+                    weight = 20 + xorshift32(&state) % 21;
+                src[numEdges] = v; dest[numEdges] = neighbours[k]; w[numEdges++] = weight;
+                src[numEdges] = neighbours[k]; dest[numEdges] = v; w[numEdges++] = weight;
+            }
+        }
+    }
+
+    struct CSRGraph* graph = createCSRGraph(n, numEdges, src, dest, w);
+    free(src);
+    free(dest);
+    free(w);
+    return graph;
+}
+
+// Compare early-exit Dijkstra with A* and each heuristic on random grid pairs
+void benchmarkAStar(int side, int numQueries, int numLandmarks) {
+    printf("A* benchmark: %d x %d grid, %d queries, %d landmarks\n", side, side, numQueries, numLandmarks);
+    struct Coordinates coords;
+    struct CSRGraph* graph = createGridGraph(side, side, 12345, &coords);
+    struct CSRGraph* reverse = createReverseCSRGraph(graph);
+    struct SearchScratch* scratch = createSearchScratch(graph->numVertices);
+
+    double start = nowSeconds();
+    struct Landmarks* lm = createLandmarks(graph, reverse, numLandmarks);
+    printf("Landmark preprocessing: %.3f s\nLandmarks:", nowSeconds() - start);
+    for (int l = 0; l < lm->numLandmarks; l++)
+        printf(" %d", lm->landmark[l]);
+    printf("\n\n");
+
+    const char* names[4] = { "dijkstra", "euclidean", "manhattan", "landmarks" };
+    struct Heuristic heuristics[4] = {
+        { NULL, NULL },
+        { euclideanHeuristic, &coords },
+        { manhattanHeuristic, &coords },
+        { landmarkHeuristic, lm }
+    };
+    double time[4] = {0};
+    long settled[4] = {0};
+    int mismatches = 0;
+    unsigned int state = 4242;
+
+    for (int q = 0; q < numQueries; q++) {
+        int src = xorshift32(&state) % graph->numVertices;
+        int target = xorshift32(&state) % graph->numVertices;
+        int expected = 0;
+        for (int k = 0; k < 4; k++) {
+            struct PathResult result;
+            start = nowSeconds();
+            if (k == 0)
+                dijkstraPointToPoint(graph, src, target, scratch, &result);
+            else
+                aStarSearch(graph, src, target, heuristics[k], scratch, &result);
+            time[k] += nowSeconds() - start;
+            settled[k] += result.settled;
+            if (k == 0)
+                expected = result.distance;
+            else if (result.distance != expected || pathWeight(graph, &result) != expected)
+                mismatches++;
+            free(result.path);
+        }
+    }
+
+    printf("Search        Avg time   Avg settled\n");
+    for (int k = 0; k < 4; k++)
+        printf("%-10s %8.3f ms %12ld\n", names[k], 1000 * time[k] / numQueries, settled[k] / numQueries);
+    printf("Paths %s\n", mismatches == 0 ? "match Dijkstra" : "DIFFER from Dijkstra");
+
+    freeLandmarks(lm);
+    freeSearchScratch(scratch);
+    freeCSRGraph(reverse);
+    freeCSRGraph(graph);
+    free(coords.x);
+    free(coords.y);
+}
+
+// Report preprocessing time, index size and query latency of a contraction
+// hierarchy against Dijkstra on a grid graph (road-like weights if road)
+void benchmarkContractionHierarchy(int side, int numQueries, const char* indexPath, bool road) {
+    printf("Contraction hierarchy benchmark: %d x %d %s, %d queries\n", side, side,
+           road ? "road grid" : "grid", numQueries);
+    struct CSRGraph* graph = road ? createRoadGraph(side, side, 12345) : createGridGraph(side, side, 12345, NULL);
+    struct CSRGraph* reverse = createReverseCSRGraph(graph);
+    int n = graph->numVertices;
+
+    double start = nowSeconds();
+    struct ContractionHierarchy* built = buildContractionHierarchy(graph);
+    double buildTime = nowSeconds() - start;
+    bool saved = saveContractionHierarchy(built, indexPath);
+    freeContractionHierarchy(built);
+
+    start = nowSeconds();
+    struct ContractionHierarchy* ch = saved ? loadContractionHierarchy(indexPath) : NULL;
+    double loadTime = nowSeconds() - start;
+    if (ch == NULL) {
+        freeCSRGraph(reverse);
+        freeCSRGraph(graph);
+        return;
+    }
+    FILE* file = fopen(indexPath, "rb");
+    fseek(file, 0, SEEK_END);
+    long indexBytes = ftell(file);
+    fclose(file);
+
+    printf("Preprocessing:  %.3f s\n", buildTime);
+    printf("Shortcuts:      %d (graph has %d edges)\n", ch->numShortcuts, graph->numEdges);
+    printf("Index size:     %.2f MB (%s, loaded in %.3f s)\n\n", indexBytes / 1e6, indexPath, loadTime);
+
+    struct SearchScratch* forward = createSearchScratch(n);
+    struct SearchScratch* backward = createSearchScratch(n);
+    double time[3] = {0};
+    long settled[3] = {0};
+    int mismatches = 0;
+    unsigned int state = 31337;
+
+    for (int q = 0; q < numQueries; q++) {
+        int src = xorshift32(&state) % n;
+        int target = xorshift32(&state) % n;
+        struct PathResult p2p, bidir;
+
+        start = nowSeconds();
+        dijkstraPointToPoint(graph, src, target, forward, &p2p);
+        time[0] += nowSeconds() - start;
+
+        start = nowSeconds();
+        dijkstraBidirectional(graph, reverse, src, target, forward, backward, &bidir);
+        time[1] += nowSeconds() - start;
+
+        int chSettled;
+        start = nowSeconds();
+        int chDist = chQuery(ch, src, target, forward, backward, &chSettled);
+        time[2] += nowSeconds() - start;
+
+        settled[0] += p2p.settled;
+        settled[1] += bidir.settled;
+        settled[2] += chSettled;
+        if (chDist != p2p.distance || bidir.distance != p2p.distance)
+            mismatches++;
+        free(p2p.path);
+        free(bidir.path);
+    }
+
+    const char* names[3] = { "dijkstra", "bidirectional", "hierarchy" };
+    printf("Search            Avg time   Avg settled\n");
+    for (int k = 0; k < 3; k++)
+        printf("%-14s %8.4f ms %12ld\n", names[k], 1000 * time[k] / numQueries, settled[k] / numQueries);
+    printf("Distances %s\n", mismatches == 0 ? "match Dijkstra" : "DIFFER from Dijkstra");
+
+    freeSearchScratch(forward);
+    freeSearchScratch(backward);
+    freeContractionHierarchy(ch);
+    freeCSRGraph(reverse);
+    freeCSRGraph(graph);
+}
+
+// Measure update latency of the dynamic tree against full recomputation
+void benchmarkDynamic(int numVertices, int numEdges, int numUpdates) {
+    printf("Dynamic SSSP benchmark: V = %d, E = %d, %d weight updates\n", numVertices, numEdges, numUpdates);
+    struct CSRGraph* graph = createRandomGraph(numVertices, numEdges, 255, 12345);
+    int* dist = (int*)malloc(numVertices * sizeof(int));
+
+    double start = nowSeconds();
+    struct DynamicSSSP* ds = createDynamicSSSP(graph, 0);
+    double initTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    dijkstra(graph, 0, dist, BINARY_HEAP);
+    double fullTime = nowSeconds() - start;
+
+    unsigned int state = 2024;
+    double updateTime = 0, maxUpdate = 0;
+    for (int i = 0; i < numUpdates; i++) {
+        int e = xorshift32(&state) % numEdges;
+        int weight = 1 + xorshift32(&state) % 255;
+        start = nowSeconds();
+        dynamicUpdateEdge(ds, e, weight);
+        double t = nowSeconds() - start;
+        updateTime += t;
+        if (t > maxUpdate)
+            maxUpdate = t;
+    }
+
+    dijkstra(graph, 0, dist, BINARY_HEAP);
+    bool same = memcmp(dist, ds->dist, numVertices * sizeof(int)) == 0;
+    printf("Initial tree:        %10.3f ms\n", 1000 * initTime);
+    printf("Full recomputation:  %10.3f ms\n", 1000 * fullTime);
+    printf("Update, average:     %10.3f ms\n", 1000 * updateTime / numUpdates);
+    printf("Update, worst:       %10.3f ms\n", 1000 * maxUpdate);
+    printf("Speedup per update:  %10.1fx, distances %s\n", fullTime * numUpdates / updateTime,
+           same ? "match recomputation" : "DIFFER from recomputation");
+
+    freeDynamicSSSP(ds);
+    free(dist);
+    freeCSRGraph(graph);
+}
+
+// Function to relabel a CSR graph: vertex v becomes newId[v]
+struct CSRGraph* relabelCSRGraph(const struct CSRGraph* graph, const int newId[]) {
+    struct CSRGraph* relabelled = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    relabelled->numVertices = graph->numVertices;
+    relabelled->numEdges = graph->numEdges;
+    relabelled->rowStart = (int*)malloc(((size_t)graph->numVertices + 1) * sizeof(int));
+    relabelled->adj = (int*)malloc(((size_t)graph->numEdges + 1) * sizeof(int));
+    relabelled->weight = (int*)malloc(((size_t)graph->numEdges + 1) * sizeof(int));
+    permuteCSR(graph->numVertices, graph->rowStart, graph->adj, graph->weight, newId,
+               relabelled->rowStart, relabelled->adj, relabelled->weight);
+    return relabelled;
+}
+
+// Check that dist[] on every reordering, read back through newId[], equals
+// the distances on the input numbering
+bool checkReorder(const struct CSRGraph* graph, int src, unsigned int seed) {
+    int V = graph->numVertices;
+    int* newId = (int*)malloc(V * sizeof(int));
+    int* expected = (int*)malloc(V * sizeof(int));
+    int* dist = (int*)malloc(V * sizeof(int));
+    dijkstra(graph, src, expected, BINARY_HEAP);
+    bool ok = true;
+    for (int t = REORDER_DEGREE; t < NUM_REORDER_TYPES && ok; t++) {
+        computeOrder((enum ReorderType)t, V, graph->rowStart, graph->adj, seed, newId);
+        ok = isPermutation(V, newId);
+        if (!ok)
+            break;
+        struct CSRGraph* relabelled = relabelCSRGraph(graph, newId);
+        for (int q = 0; q < 2 && ok; q++) {
+            dijkstra(relabelled, newId[src], dist, (enum QueueType)q);
+            for (int v = 0; v < V && ok; v++)
+                ok = dist[newId[v]] == expected[v];
+        }
+        freeCSRGraph(relabelled);
+    }
+    free(newId);
+    free(expected);
+    free(dist);
+    return ok;
+}
+
+// Compare the binary heap and Dial's buckets on a grid numbered in random
+// order and after each reordering
+void benchmarkReorder(int side, int numSources) {
+    printf("Reorder benchmark: %d x %d grid in random order, %d sources\n", side, side, numSources);
+    struct CSRGraph* grid = createGridGraph(side, side, 12345, NULL);
+    int V = grid->numVertices;
+    int* newId = (int*)malloc(V * sizeof(int));
+    randomOrder(V, 12345, newId);
+    struct CSRGraph* graph = relabelCSRGraph(grid, newId);
+    freeCSRGraph(grid);
+
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    int* expected = (int*)malloc((size_t)numSources * V * sizeof(int));
+    int* dist = (int*)malloc(V * sizeof(int));
+    unsigned int state = 12345;
+    for (int i = 0; i < numSources; i++) {
+        sources[i] = xorshift32(&state) % V;
+        dijkstra(graph, sources[i], expected + (size_t)i * V, BINARY_HEAP);
+    }
+
+    int counter = openCacheMissCounter();
+    if (counter < 0)
+        printf("(Hardware cache miss counters are not available here)\n");
+    printf("\nOrder       Reorder   Avg edge gap   Binary heap   Dial buckets   Cache misses/search   Distances\n");
+    for (int t = REORDER_NONE; t < REORDER_RANDOM; t++) {
+        double start = nowSeconds();
+        computeOrder((enum ReorderType)t, V, graph->rowStart, graph->adj, 1, newId);
+        struct CSRGraph* relabelled = relabelCSRGraph(graph, newId);
+        double reorderTime = nowSeconds() - start;
+
+        double time[2] = { 0, 0 };
+        long long misses = 0;
+        bool same = true;
+        for (int q = 0; q < 2; q++) {
+            for (int i = 0; i < numSources; i++) {
+                startCacheMissCounter(counter);
+                start = nowSeconds();
+                dijkstra(relabelled, newId[sources[i]], dist, (enum QueueType)q);
+                time[q] += nowSeconds() - start;
+                misses += stopCacheMissCounter(counter);
+                for (int v = 0; v < V && same; v++)
+                    same = dist[newId[v]] == expected[(size_t)i * V + v];
+            }
+        }
+        char missText[32] = "n/a";
+        if (counter >= 0)
+            snprintf(missText, sizeof(missText), "%lld", misses / (2 * numSources));
+        printf("%-10s %6.2f s   %12.1f   %8.2f ms    %8.2f ms   %19s   %s\n", reorderName((enum ReorderType)t),
+               reorderTime, averageEdgeGap(V, relabelled->rowStart, relabelled->adj),
+               time[0] * 1000 / numSources, time[1] * 1000 / numSources, missText, same ? "match" : "DIFFER");
+        freeCSRGraph(relabelled);
+    }
+    closeCacheMissCounter(counter);
+
+    free(newId);
+    free(sources);
+    free(expected);
+    free(dist);
+    freeCSRGraph(graph);
+}
+
+// Time the int kernel and every typed kernel on the same random graph
+void benchmarkTyped(int numVertices, int numEdges) {
+    printf("Typed kernel benchmark: V = %d, E = %d\n", numVertices, numEdges);
+    struct CSRGraph* graph = createRandomGraph(numVertices, numEdges, 255, 12345);
+    int* expected = (int*)malloc(numVertices * sizeof(int));
+    uint64_t* distU64 = (uint64_t*)malloc(numVertices * sizeof(uint64_t));
+    float* distF32 = (float*)malloc(numVertices * sizeof(float));
+    double* distF64 = (double*)malloc(numVertices * sizeof(double));
+    struct CSRGraphU32* graphU32 = createCSRGraphU32(graph, weightToU32);
+    struct CSRGraphU64* graphU64 = createCSRGraphU64(graph, weightToU64);
+    struct CSRGraphF32* graphF32 = createCSRGraphF32(graph, weightToF32);
+    struct CSRGraphF64* graphF64 = createCSRGraphF64(graph, weightToF64);
+    double time[5];
+    int mismatches[5] = {0};
+
+    double start = nowSeconds();
+    dijkstra(graph, 0, expected, BINARY_HEAP);
+    time[0] = nowSeconds() - start;
+
+    start = nowSeconds();
+    dijkstraTyped(graphU32, 0, distU64);
+    time[1] = nowSeconds() - start;
+    for (int v = 0; v < numVertices; v++)
+        mismatches[1] += distU64[v] != (uint64_t)expected[v];
+
+    start = nowSeconds();
+    dijkstraTyped(graphU64, 0, distU64);
+    time[2] = nowSeconds() - start;
+    for (int v = 0; v < numVertices; v++)
+        mismatches[2] += distU64[v] != (uint64_t)expected[v];
+
+    start = nowSeconds();
+    dijkstraTyped(graphF32, 0, distF32);
+    time[3] = nowSeconds() - start;
+    for (int v = 0; v < numVertices; v++)
+        mismatches[3] += distF32[v] != (float)expected[v];
+
+    start = nowSeconds();
+    dijkstraTyped(graphF64, 0, distF64);
+    time[4] = nowSeconds() - start;
+    for (int v = 0; v < numVertices; v++)
+        mismatches[4] += distF64[v] != (double)expected[v];
+
+    const char* names[5] = { "int", "uint32", "uint64", "float", "double" };
+    printf("Weights       Time\n");
+    for (int k = 0; k < 5; k++)
+        printf("%-7s %8.3f s %s\n", names[k], time[k], mismatches[k] ? "DISTANCES DIFFER" : "");
+
+    freeCSRGraphU32(graphU32);
+    freeCSRGraphU64(graphU64);
+    freeCSRGraphF32(graphF32);
+    freeCSRGraphF64(graphF64);
+    free(expected);
+    free(distU64);
+    free(distF32);
+    free(distF64);
+    freeCSRGraph(graph);
+}
+
+// Run single-source shortest paths on a memory-mapped graph file
+// The CSRGraph borrows the arrays of the mapping, so loading copies nothing
+bool solveGraphFile(const char* path, int src, enum QueueType queue, bool useDelta) {
+    double start = nowSeconds();
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return false;
+    double loadTime = nowSeconds() - start;
+    if (src < 0 || src >= file->numVertices) {
+        printf("Source must be between 0 and %d\n", file->numVertices - 1);
+        closeGraphFile(file);
+        return false;
+    }
+
+    struct CSRGraph graph = { file->numVertices, file->numEdges, file->rowStart, file->adj, file->weight };
+    for (int e = 0; e < graph.numEdges; e++) {
+        if (graph.weight[e] < 0) {
+            printf("Edge %d has negative weight %d\n", e, graph.weight[e]);
+            closeGraphFile(file);
+            return false;
+        }
+    }
+    printf("Mapped %s: %d vertices, %d edges in %.3f ms\n", path, graph.numVertices, graph.numEdges, loadTime * 1000);
+
+    int* dist = (int*)malloc(graph.numVertices * sizeof(int));
+    start = nowSeconds();
+    if (useDelta) {
+        int delta = maxEdgeWeight(&graph) > 0 ? maxEdgeWeight(&graph) : 1;
+        printf("Delta-stepping, delta = %d, %d threads\n", delta, numCPUs());
+        dijkstraDeltaStepping(&graph, src, dist, delta, numCPUs());
+    } else {
+        printf("Priority queue: %s\n", queueName(queue));
+        dijkstra(&graph, src, dist, queue);
+    }
+    double solveTime = nowSeconds() - start;
+
+    if (graph.numVertices <= 20) {
+        printf("\n");
+        printSolution(dist, graph.numVertices);
+    }
+    int reached = 0, farthest = 0;
+    for (int v = 0; v < graph.numVertices; v++) {
+        if (dist[v] != INT_MAX) {
+            reached++;
+            if (dist[v] > farthest)
+                farthest = dist[v];
+        }
+    }
+    printf("\nReached %d of %d vertices from %d, farthest at distance %d (%.3f s)\n",
+           reached, graph.numVertices, src, farthest, solveTime);
+
+    free(dist);
+    closeGraphFile(file);
+    return true;
+}
+
+// Build a contraction hierarchy of a graph file, or of a generated grid when
+// source is a number (the grid side), and save it to indexPath
+bool buildHierarchyIndex(const char* indexPath, const char* source) {
+    struct GraphFile* file = NULL;
+    struct CSRGraph* grid = NULL;
+    struct CSRGraph graph;
+    if (strspn(source, "0123456789") == strlen(source)) {
+        int side = atoi(source);
+        if (side < 2 || side > 23170) {
+            printf("Grid side must be between 2 and 23170\n");
+            return false;
+        }
+        grid = createGridGraph(side, side, 12345, NULL);
+        graph = *grid;
+    } else {
+        file = openGraphFile(source);
+        if (file == NULL)
+            return false;
+        graph = (struct CSRGraph){ file->numVertices, file->numEdges, file->rowStart, file->adj, file->weight };
+        for (int e = 0; e < graph.numEdges; e++) {
+            if (graph.weight[e] < 0) {
+                printf("Edge %d has negative weight %d\n", e, graph.weight[e]);
+                closeGraphFile(file);
+                return false;
             }
         }
     }
-    
-    // Print the constructed distance array
-    printSolution(dist);
+
+    double start = nowSeconds();
+    struct ContractionHierarchy* ch = buildContractionHierarchy(&graph);
+    double buildTime = nowSeconds() - start;
+    bool saved = saveContractionHierarchy(ch, indexPath);
+    if (saved)
+        printf("Saved %d vertices and %d shortcuts (graph has %d edges) to %s in %.3f s\n",
+               ch->numVertices, ch->numShortcuts, graph.numEdges, indexPath, buildTime);
+    freeContractionHierarchy(ch);
+    if (grid)
+        freeCSRGraph(grid);
+    if (file)
+        closeGraphFile(file);
+    return saved;
 }
 
 // Driver program to test above functions
-int main() {
+// Usage: ./1_dijkstra [heap|dial|delta]
+//        ./1_dijkstra file graphFile [src] [heap|dial|delta]
+//        ./1_dijkstra bench [V] [E] [maxWeight] [delta] [threads]
+//        ./1_dijkstra bench-batch [V] [E] [sources] [threads]
+//        ./1_dijkstra bench-p2p [V] [E] [queries]
+//        ./1_dijkstra bench-astar [gridSide] [queries] [landmarks]
+//        ./1_dijkstra bench-ch [gridSide] [queries] [indexFile] [grid|road]
+//        ./1_dijkstra ch-build indexFile [gridSide | graphFile]
+//        ./1_dijkstra ch-query indexFile src target
+//        ./1_dijkstra bench-dynamic [V] [E] [updates]
+//        ./1_dijkstra bench-typed [V] [E]
+//        ./1_dijkstra bench-reorder [gridSide] [sources]
+int main(int argc, char* argv[]) {
+    if (argc > 2 && strcmp(argv[1], "file") == 0) {
+        int src = argc > 3 ? atoi(argv[3]) : 0;
+        const char* mode = argc > 4 ? argv[4] : "heap";
+        if (strcmp(mode, "heap") != 0 && strcmp(mode, "dial") != 0 && strcmp(mode, "delta") != 0) {
+            printf("Unknown mode %s (heap, dial or delta)\n", mode);
+            return 1;
+        }
+        bool useDelta = strcmp(mode, "delta") == 0;
+        enum QueueType queue = strcmp(mode, "dial") == 0 ? DIAL_BUCKETS : BINARY_HEAP;
+        return solveGraphFile(argv[2], src, queue, useDelta) ? 0 : 1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-reorder") == 0) {
+        int side = argc > 2 ? atoi(argv[2]) : 2000;
+        int numSources = argc > 3 ? atoi(argv[3]) : 4;
+        if (side < 2 || side > 16384 || numSources < 1 || (long long)numSources * side * side > INT_MAX) {
+            printf("Reorder benchmark needs 2 <= gridSide <= 16384 and 1 <= sources * gridSide^2 < 2^31\n");
+            return 1;
+        }
+        benchmarkReorder(side, numSources);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-typed") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 3000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 10000000;
+        if (numVertices < 1 || numEdges < numVertices) {
+            printf("Typed benchmark needs V >= 1 and E >= V\n");
+            return 1;
+        }
+        benchmarkTyped(numVertices, numEdges);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-dynamic") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 1000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 3000000;
+        int numUpdates = argc > 4 ? atoi(argv[4]) : 500;
+        if (numVertices < 1 || numEdges < numVertices || numUpdates < 1) {
+            printf("Dynamic benchmark needs V >= 1, E >= V and updates >= 1\n");
+            return 1;
+        }
+        benchmarkDynamic(numVertices, numEdges, numUpdates);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-ch") == 0) {
+        int side = argc > 2 ? atoi(argv[2]) : 150;
+        int numQueries = argc > 3 ? atoi(argv[3]) : 200;
+        const char* indexPath = argc > 4 ? argv[4] : "ch_index.bin";
+        const char* kind = argc > 5 ? argv[5] : "grid";
+        bool road = strcmp(kind, "road") == 0;
+        if (side < 2 || side > 23170 || numQueries < 1 || (!road && strcmp(kind, "grid") != 0)) {
+            printf("Contraction hierarchy benchmark needs 2 <= gridSide <= 23170, queries >= 1 and grid or road\n");
+            return 1;
+        }
+        benchmarkContractionHierarchy(side, numQueries, indexPath, road);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "ch-build") == 0)
+        return buildHierarchyIndex(argv[2], argc > 3 ? argv[3] : "150") ? 0 : 1;
+    if (argc > 4 && strcmp(argv[1], "ch-query") == 0) {
+        struct ContractionHierarchy* ch = loadContractionHierarchy(argv[2]);
+        if (ch == NULL)
+            return 1;
+        int src = atoi(argv[3]), target = atoi(argv[4]);
+        if (src < 0 || src >= ch->numVertices || target < 0 || target >= ch->numVertices) {
+            printf("Vertices must be between 0 and %d\n", ch->numVertices - 1);
+            freeContractionHierarchy(ch);
+            return 1;
+        }
+        struct SearchScratch* forward = createSearchScratch(ch->numVertices);
+        struct SearchScratch* backward = createSearchScratch(ch->numVertices);
+        int settled;
+        int distance = chQuery(ch, src, target, forward, backward, &settled);
+        if (distance == INT_MAX)
+            printf("%d is not reachable from %d\n", target, src);
+        else
+            printf("Distance from %d to %d: %d (%d vertices settled)\n", src, target, distance, settled);
+        freeSearchScratch(forward);
+        freeSearchScratch(backward);
+        freeContractionHierarchy(ch);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-astar") == 0) {
+        int side = argc > 2 ? atoi(argv[2]) : 1000;
+        int numQueries = argc > 3 ? atoi(argv[3]) : 20;
+        int numLandmarks = argc > 4 ? atoi(argv[4]) : 8;
+        if (side < 2 || numQueries < 1 || numLandmarks < 1) {
+            printf("A* benchmark needs gridSide >= 2 and queries, landmarks >= 1\n");
+            return 1;
+        }
+        benchmarkAStar(side, numQueries, numLandmarks);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-p2p") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 1000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 3000000;
+        int numQueries = argc > 4 ? atoi(argv[4]) : 20;
+        if (numVertices < 1 || numEdges < numVertices || numQueries < 1) {
+            printf("Point-to-point benchmark needs V >= 1, E >= V and queries >= 1\n");
+            return 1;
+        }
+        benchmarkPointToPoint(numVertices, numEdges, numQueries);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench-batch") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 100000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 300000;
+        int numSources = argc > 4 ? atoi(argv[4]) : 200;
+        int threads = argc > 5 ? atoi(argv[5]) : numCPUs();
+        if (numVertices < 1 || numEdges < numVertices || numSources < 1 || threads < 1) {
+            printf("Batch benchmark needs V >= 1, E >= V and sources, threads >= 1\n");
+            return 1;
+        }
+        benchmarkBatch(numVertices, numEdges, numSources, threads);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 3000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 10000000;
+        int maxWeight = argc > 4 ? atoi(argv[4]) : 255;
+        int delta = argc > 5 ? atoi(argv[5]) : maxWeight;
+        int threads = argc > 6 ? atoi(argv[6]) : numCPUs();
+        if (numVertices < 1 || numEdges < numVertices || maxWeight < 1 || delta < 1 || threads < 1) {
+            printf("Benchmark needs V >= 1, E >= V and maxWeight, delta, threads >= 1\n");
+            return 1;
+        }
+        benchmark(numVertices, numEdges, maxWeight, delta, threads);
+        return 0;
+    }
+
+    enum QueueType queue = BINARY_HEAP;
+    bool useDelta = false;
+    if (argc > 1 && strcmp(argv[1], "dial") == 0)
+        queue = DIAL_BUCKETS;
+    else if (argc > 1 && strcmp(argv[1], "delta") == 0)
+        useDelta = true;
+    else if (argc > 1 && strcmp(argv[1], "heap") != 0) {
+        printf("Unknown mode %s (heap, dial or delta)\n", argv[1]);
+        return 1;
+    }
+
     /* Example graph represented as adjacency matrix */
-    int graph[V][V] = {
-        {0, 4, 0, 0, 0, 0, 0, 8, 0},
-        {4, 0, 8, 0, 0, 0, 0, 11, 0},
-        {0, 8, 0, 7, 0, 4, 0, 0, 2},
-        {0, 0, 7, 0, 9, 14, 0, 0, 0},
-        {0, 0, 0, 9, 0, 10, 0, 0, 0},
-        {0, 0, 4, 14, 10, 0, 2, 0, 0},
-        {0, 0, 0, 0, 0, 2, 0, 1, 6},
-        {8, 11, 0, 0, 0, 0, 1, 0, 7},
-        {0, 0, 2, 0, 0, 0, 6, 7, 0}
+    int n = 9;
+    int matrix[9 * 9] = {
+        0, 4, 0, 0, 0, 0, 0, 8, 0,
+        4, 0, 8, 0, 0, 0, 0, 11, 0,
+        0, 8, 0, 7, 0, 4, 0, 0, 2,
+        0, 0, 7, 0, 9, 14, 0, 0, 0,
+        0, 0, 0, 9, 0, 10, 0, 0, 0,
+        0, 0, 4, 14, 10, 0, 2, 0, 0,
+        0, 0, 0, 0, 0, 2, 0, 1, 6,
+        8, 11, 0, 0, 0, 0, 1, 0, 7,
+        0, 0, 2, 0, 0, 0, 6, 7, 0
     };
-    
+
     printf("Dijkstra's Single Source Shortest Path Algorithm\n");
     printf("=================================================\n\n");
-    
-    dijkstra(graph, 0);  // Run Dijkstra's algorithm starting from vertex 0
-    
+
+    struct CSRGraph* graph = createCSRFromMatrix(n, matrix);
+    int dist[9];
+
+    // Run Dijkstra's algorithm starting from vertex 0
+    if (useDelta) {
+        printf("Delta-stepping, delta = 3, %d threads\n\n", numCPUs());
+        dijkstraDeltaStepping(graph, 0, dist, 3, numCPUs());
+    } else {
+        printf("Priority queue: %s\n\n", queueName(queue));
+        dijkstra(graph, 0, dist, queue);
+    }
+    printSolution(dist, n);
+
+    // Cross-check the CSR version against the O(V^2) matrix version
+    printf("\nChecking against adjacency-matrix reference: %s\n",
+           checkAgainstMatrix(200, 5, 42, queue) ? "PASSED" : "FAILED");
+
+    // Cross-check delta-stepping against the heap on a larger sparse graph
+    struct CSRGraph* sparse = createRandomGraph(5000, 20000, 255, 7);
+    int* expected = (int*)malloc(5000 * sizeof(int));
+    int* actual = (int*)malloc(5000 * sizeof(int));
+    dijkstra(sparse, 0, expected, BINARY_HEAP);
+    dijkstraDeltaStepping(sparse, 0, actual, 64, 4);
+    printf("Checking delta-stepping against binary heap: %s\n",
+           memcmp(expected, actual, 5000 * sizeof(int)) == 0 ? "PASSED" : "FAILED");
+
+    // Many-to-many distances between vertices 0, 4 and 8 of the example graph
+    int batchSources[3] = {0, 4, 8};
+    int batchResult[3 * 3];
+    dijkstraBatch(graph, batchSources, 3, batchSources, 3, batchResult, 2);
+    printf("\nDistance matrix between vertices 0, 4 and 8:\n");
+    for (int i = 0; i < 3; i++)
+        printf("%d \t %d \t %d\n", batchResult[i * 3], batchResult[i * 3 + 1], batchResult[i * 3 + 2]);
+
+    // Cross-check batch queries against single-source calls on the sparse graph
+    int* batchRows = (int*)malloc(4 * 5000 * sizeof(int));
+    int rowSources[4] = {0, 17, 2500, 4999};
+    dijkstraBatch(sparse, rowSources, 4, NULL, 5000, batchRows, 3);
+    bool batchOk = true;
+    for (int i = 0; i < 4; i++) {
+        dijkstra(sparse, rowSources[i], expected, BINARY_HEAP);
+        if (memcmp(expected, batchRows + i * 5000, 5000 * sizeof(int)) != 0)
+            batchOk = false;
+    }
+    printf("Checking batch queries against single-source calls: %s\n", batchOk ? "PASSED" : "FAILED");
+    free(batchRows);
+
+    // Point-to-point queries from 0 to 4 on the example graph
+    struct CSRGraph* reverse = createReverseCSRGraph(graph);
+    struct SearchScratch* forward = createSearchScratch(n);
+    struct SearchScratch* backward = createSearchScratch(n);
+    struct PathResult path;
+    printf("\nShortest path from 0 to 4:\n");
+    dijkstraPointToPoint(graph, 0, 4, forward, &path);
+    printPath("early exit", &path);
+    free(path.path);
+    dijkstraBidirectional(graph, reverse, 0, 4, forward, backward, &path);
+    printPath("bidirectional", &path);
+    free(path.path);
+    freeSearchScratch(forward);
+    freeSearchScratch(backward);
+    freeCSRGraph(reverse);
+
+    // Cross-check A* with every heuristic against early-exit Dijkstra on a grid
+    struct Coordinates coords;
+    struct CSRGraph* grid = createGridGraph(30, 30, 5, &coords);
+    struct CSRGraph* gridReverse = createReverseCSRGraph(grid);
+    struct Landmarks* lm = createLandmarks(grid, gridReverse, 8);
+    struct Heuristic heuristics[3] = {
+        { euclideanHeuristic, &coords },
+        { manhattanHeuristic, &coords },
+        { landmarkHeuristic, lm }
+    };
+    struct SearchScratch* gridScratch = createSearchScratch(grid->numVertices);
+    bool aStarOk = true;
+    for (int q = 0; q < 100; q++) {
+        int src = (q * 37) % grid->numVertices, target = (q * 101 + 13) % grid->numVertices;
+        struct PathResult expectedPath, aStarPath;
+        dijkstraPointToPoint(grid, src, target, gridScratch, &expectedPath);
+        for (int k = 0; k < 3; k++) {
+            aStarSearch(grid, src, target, heuristics[k], gridScratch, &aStarPath);
+            if (aStarPath.distance != expectedPath.distance
+                || pathWeight(grid, &aStarPath) != expectedPath.distance)
+                aStarOk = false;
+            free(aStarPath.path);
+        }
+        free(expectedPath.path);
+    }
+    printf("Checking A* against Dijkstra on a 30 x 30 grid: %s\n", aStarOk ? "PASSED" : "FAILED");
+    printf("Checking that the 8 landmarks are distinct vertices: %s\n", distinctLandmarks(lm) ? "PASSED" : "FAILED");
+
+    // Contraction hierarchy on the same grid, then a saved index with one
+    // upward edge pointing outside the graph must be rejected when loaded
+    struct ContractionHierarchy* ch = buildContractionHierarchy(grid);
+    struct SearchScratch* chBackward = createSearchScratch(grid->numVertices);
+    bool chOk = true;
+    for (int q = 0; q < 100; q++) {
+        int src = (q * 37) % grid->numVertices, target = (q * 101 + 13) % grid->numVertices;
+        struct PathResult expectedPath;
+        int chSettled;
+        dijkstraPointToPoint(grid, src, target, gridScratch, &expectedPath);
+        if (chQuery(ch, src, target, gridScratch, chBackward, &chSettled) != expectedPath.distance)
+            chOk = false;
+        free(expectedPath.path);
+    }
+    printf("Checking contraction hierarchy against Dijkstra on a 30 x 30 grid: %s\n", chOk ? "PASSED" : "FAILED");
+    const char* chPath = "ch_selfcheck.bin";
+    bool rejected = false;
+    if (saveContractionHierarchy(ch, chPath)) {
+        // Header, rank[], the up graph's edge count and rowStart[], then adj[0]
+        FILE* file = fopen(chPath, "r+b");
+        int bad = grid->numVertices;
+        fseek(file, (long)(3 + grid->numVertices + 1 + grid->numVertices + 1) * sizeof(int), SEEK_SET);
+        fwrite(&bad, sizeof(int), 1, file);
+        fclose(file);
+        struct ContractionHierarchy* corrupt = loadContractionHierarchy(chPath);
+        rejected = corrupt == NULL;
+        if (corrupt)
+            freeContractionHierarchy(corrupt);
+        remove(chPath);
+    }
+    printf("Checking that a corrupt hierarchy file is rejected: %s\n", rejected ? "PASSED" : "FAILED");
+    freeSearchScratch(chBackward);
+    freeContractionHierarchy(ch);
+
+    // Make edge 7 -> 6 dearer and repair the tree instead of starting over
+    struct DynamicSSSP* ds = createDynamicSSSP(graph, 0);
+    dynamicUpdateEdge(ds, findEdge(graph, 7, 6), 10);
+    printf("\nAfter changing the weight of edge 7 -> 6 from 1 to 10:\n");
+    printSolution(ds->dist, n);
+    dijkstra(graph, 0, dist, BINARY_HEAP);
+    printf("Checking repaired distances against recomputation: %s\n",
+           memcmp(dist, ds->dist, n * sizeof(int)) == 0 ? "PASSED" : "FAILED");
+    freeDynamicSSSP(ds);
+
+    // Fractional weights: every edge of the updated example graph costs weight / 4
+    struct CSRGraphF64* fractional = createCSRGraphF64(graph, weightToF64);
+    for (int e = 0; e < fractional->numEdges; e++)
+        fractional->weight[e] /= 4;
+    double fractionalDist[9];
+    dijkstraTyped(fractional, 0, fractionalDist);
+    printf("\nWith every weight divided by 4 (double kernel):\n");
+    printf("Vertex \t\t Distance from Source\n");
+    for (int i = 0; i < n; i++)
+        printf("%d \t\t %.2f\n", i, fractionalDist[i]);
+    freeCSRGraphF64(fractional);
+
+    // A chain of 2^62 weights: 64-bit distances do not overflow on 3 edges;
+    // 4 edges do not fit, which leaves vertex 4 at UINT64_MAX and is reported.
+    // With a bypass edge 0 -> 4 of weight 1 the overflowing sum is irrelevant
+    int chainSrc[4] = {0, 1, 2, 3}, chainDest[4] = {1, 2, 3, 4}, chainW[4] = {1, 1, 1, 1};
+    struct CSRGraph* chain = createCSRGraph(5, 4, chainSrc, chainDest, chainW);
+    struct CSRGraphU64* chainU64 = createCSRGraphU64(chain, weightToU64);
+    for (int e = 0; e < 4; e++)
+        chainU64->weight[e] = (uint64_t)1 << 62;
+    uint64_t chainDist[5];
+    bool chainFits = dijkstraTyped(chainU64, 0, chainDist);
+    chainU64->weight[3] = 1;
+    uint64_t shortDist[5];
+    bool shortFits = dijkstraTyped(chainU64, 0, shortDist);
+    int bypassSrc[5] = {0, 1, 2, 3, 0}, bypassDest[5] = {1, 2, 3, 4, 4}, bypassW[5] = {1, 1, 1, 1, 1};
+    struct CSRGraph* bypass = createCSRGraph(5, 5, bypassSrc, bypassDest, bypassW);
+    struct CSRGraphU64* bypassU64 = createCSRGraphU64(bypass, weightToU64);
+    for (int e = 0; e < 5; e++)
+        bypassU64->weight[e] = (uint64_t)1 << 62;
+    bypassU64->weight[1] = 1;  // Row 0 holds 0 -> 1, then the bypass 0 -> 4
+    uint64_t bypassDist[5];
+    bool bypassFits = dijkstraTyped(bypassU64, 0, bypassDist);
+    printf("Checking uint64 distances and overflow reporting on a chain of 2^62 weights: %s\n",
+           chainDist[3] == 3 * ((uint64_t)1 << 62) && chainDist[4] == UINT64_MAX && !chainFits
+           && shortFits && shortDist[4] == 3 * ((uint64_t)1 << 62) + 1
+           && bypassFits && bypassDist[4] == 1 ? "PASSED" : "FAILED");
+    freeCSRGraphU64(bypassU64);
+    freeCSRGraph(bypass);
+
+    // Reordered copies of the sparse graph and the grid give the same distances
+    printf("Checking Dijkstra on reordered graphs mapped back to the input numbering: %s\n",
+           checkReorder(sparse, 0, 3) && checkReorder(grid, 17, 4) ? "PASSED" : "FAILED");
+    freeCSRGraphU64(chainU64);
+    freeCSRGraph(chain);
+    freeSearchScratch(gridScratch);
+    freeLandmarks(lm);
+    freeCSRGraph(gridReverse);
+    freeCSRGraph(grid);
+    free(coords.x);
+    free(coords.y);
+
+    free(expected);
+    free(actual);
+    freeCSRGraph(sparse);
+
+    freeCSRGraph(graph);
     return 0;
 }
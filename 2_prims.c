@@ -1,6 +1,6 @@
 /*
  * Minimum Spanning Tree using Prim's Algorithm (Greedy Method)
- * 
+ *
  * Pseudocode:
  * 1. Create a set mstSet to keep track of vertices already included in MST
  * 2. Assign a key value to all vertices (Initialize all keys as INFINITE)
@@ -12,65 +12,259 @@
  *       - For every adjacent vertex v, if weight of edge u-v is less than
  *         the previous key value of v, update the key value as weight of u-v
  * 5. Print the edges and their weights in the MST
+ *
+ * With an adjacency matrix, step 4a is a linear scan and step 4c visits a
+ * whole row, so Prim takes O(V^2). That is the best possible for dense
+ * graphs, and primMST() keeps this version.
+ *
+ * For sparse graphs primHeap() stores the graph in Compressed Sparse Row
+ * (CSR) form, where the edges of u are adj[rowStart[u] .. rowStart[u+1]-1],
+ * and keeps the vertices outside the tree in an indexed binary min-heap:
+ *    a. Extract the vertex u with the smallest key in O(log V)
+ *    b. For each edge (u, v) with v outside the tree and weight < key[v],
+ *       lower key[v] and move v up in the heap (decrease-key)
+ * If the graph is not connected, the search restarts from the next vertex
+ * outside the tree, giving a minimum spanning forest.
+ * Time Complexity: O((V + E) log V), Space Complexity: O(V + E)
+ *
+ * Complete graphs (distance matrices) are dense by nature, and there the
+ * O(V^2) matrix version is optimal. primDenseFloat() and primDenseInt() run
+ * it on a row-major float or int matrix of any size and fuse both passes of
+ * every step, lowering the keys from row u and finding the next minimum, into
+ * one loop that handles 8 (AVX2) or 4 (SSE4.1) vertices per instruction.
+ * Vertices already in the tree are masked with max(row[v], blocked[v]), so
+ * the loop has no branches. The instruction set is picked at run time, with
+ * a plain C loop for other CPUs.
+ *
+ * The graph can also be read from a graph file (see graph_file.h) and is
+ * then solved with the heap version.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include "graph_file.h"
+#include "union_find.h"
 
-#define V 5  // Number of vertices in the graph
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
+#define MAX_MATRIX_VERTICES 8192  // Largest graph the benchmark runs as a matrix
+
+// Structure to represent a weighted undirected graph in CSR form
+// Every edge is stored twice, once in the row of each endpoint
+struct CSRGraph {
+    int numVertices;
+    int numEdges;   // Stored edges (twice the number of undirected edges)
+    int* rowStart;  // rowStart[u] .. rowStart[u+1]-1 index the edges of u
+    int* adj;       // adj[e] is the other endpoint of edge e
+    int* weight;    // weight[e] is the weight of edge e
+};
+
+// Structure to represent an indexed binary min-heap of vertices keyed by key[]
+struct MinHeap {
+    int size;
+    int* vertex;  // vertex[i] is the vertex stored at heap slot i
+    int* pos;     // pos[v] is the heap slot of v, or -1 if v is not in the heap
+    int* key;     // key[v] is the lightest known edge from v to the tree
+};
+
+// Structure to represent an edge, used by the Kruskal reference
+struct Edge {
+    int src, dest, weight;
+};
+
+// Function to build an undirected CSR graph from an edge list (src[i] - dest[i], w[i])
+// Edges are bucketed by endpoint with a counting sort, so this runs in O(V + E)
+struct CSRGraph* createCSRGraph(int numVertices, int numEdges,
+                                const int src[], const int dest[], const int w[]) {
+    struct CSRGraph* graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    graph->numVertices = numVertices;
+    graph->numEdges = 2 * numEdges;
+    graph->rowStart = (int*)calloc(numVertices + 1, sizeof(int));
+    graph->adj = (int*)malloc(2 * (size_t)numEdges * sizeof(int));
+    graph->weight = (int*)malloc(2 * (size_t)numEdges * sizeof(int));
+
+    // Count the degree of every vertex
+    for (int i = 0; i < numEdges; i++) {
+        graph->rowStart[src[i] + 1]++;
+        graph->rowStart[dest[i] + 1]++;
+    }
+
+    // Prefix sum turns degrees into row offsets
+    for (int u = 0; u < numVertices; u++)
+        graph->rowStart[u + 1] += graph->rowStart[u];
+
+    // Scatter both directions of every edge into their rows
+    int* next = (int*)malloc(numVertices * sizeof(int));
+    memcpy(next, graph->rowStart, numVertices * sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        int e = next[src[i]]++;
+        graph->adj[e] = dest[i];
+        graph->weight[e] = w[i];
+        e = next[dest[i]]++;
+        graph->adj[e] = src[i];
+        graph->weight[e] = w[i];
+    }
+    free(next);
+
+    return graph;
+}
+
+// Function to free a CSR graph
+void freeCSRGraph(struct CSRGraph* graph) {
+    free(graph->rowStart);
+    free(graph->adj);
+    free(graph->weight);
+    free(graph);
+}
+
+// Function to create an empty heap able to hold every vertex
+// key[] is the key array owned by the caller
+struct MinHeap* createMinHeap(int numVertices, int key[]) {
+    struct MinHeap* heap = (struct MinHeap*)malloc(sizeof(struct MinHeap));
+    heap->size = 0;
+    heap->vertex = (int*)malloc(numVertices * sizeof(int));
+    heap->pos = (int*)malloc(numVertices * sizeof(int));
+    heap->key = key;
+    for (int v = 0; v < numVertices; v++)
+        heap->pos[v] = -1;
+    return heap;
+}
+
+// Function to free a heap (the key array belongs to the caller)
+void freeMinHeap(struct MinHeap* heap) {
+    free(heap->vertex);
+    free(heap->pos);
+    free(heap);
+}
+
+// Move the vertex at slot i up until its parent has a smaller key
+void siftUp(struct MinHeap* heap, int i) {
+    int v = heap->vertex[i];
+    int k = heap->key[v];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        int p = heap->vertex[parent];
+        if (heap->key[p] <= k)
+            break;
+        heap->vertex[i] = p;
+        heap->pos[p] = i;
+        i = parent;
+    }
+    heap->vertex[i] = v;
+    heap->pos[v] = i;
+}
+
+// Move the vertex at slot i down until both children have larger keys
+void siftDown(struct MinHeap* heap, int i) {
+    int v = heap->vertex[i];
+    int k = heap->key[v];
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= heap->size)
+            break;
+        if (child + 1 < heap->size
+            && heap->key[heap->vertex[child + 1]] < heap->key[heap->vertex[child]])
+            child++;
+        int c = heap->vertex[child];
+        if (heap->key[c] >= k)
+            break;
+        heap->vertex[i] = c;
+        heap->pos[c] = i;
+        i = child;
+    }
+    heap->vertex[i] = v;
+    heap->pos[v] = i;
+}
+
+// Insert v, or restore heap order after key[v] has been lowered (decrease-key)
+void heapPushOrDecrease(struct MinHeap* heap, int v) {
+    if (heap->pos[v] == -1) {
+        heap->vertex[heap->size] = v;
+        heap->pos[v] = heap->size;
+        heap->size++;
+    }
+    siftUp(heap, heap->pos[v]);
+}
+
+// Remove and return the vertex with the smallest key
+int heapExtractMin(struct MinHeap* heap) {
+    int min = heap->vertex[0];
+    heap->pos[min] = -1;
+    heap->size--;
+    if (heap->size > 0) {
+        heap->vertex[0] = heap->vertex[heap->size];
+        siftDown(heap, 0);
+    }
+    return min;
+}
 
 // Function to find the vertex with minimum key value from the set of vertices
-// not yet included in MST
-int minKey(int key[], bool mstSet[]) {
-    int min = INT_MAX, min_index;
-    
+// not yet included in MST (-1 if the remaining vertices are unreachable)
+int minKey(int V, int key[], bool mstSet[]) {
+    int min = INT_MAX, min_index = -1;
+
     for (int v = 0; v < V; v++) {
         if (mstSet[v] == false && key[v] < min) {
             min = key[v];
             min_index = v;
         }
     }
-    
+
     return min_index;
 }
 
 // Function to print the constructed MST stored in parent[]
-void printMST(int parent[], int graph[V][V]) {
+// key[v] is the weight of the edge from v to parent[v]
+void printMST(int V, int parent[], int key[]) {
     printf("Edge \t\tWeight\n");
-    int totalWeight = 0;
-    for (int i = 1; i < V; i++) {
-        printf("%d - %d \t\t%d\n", parent[i], i, graph[i][parent[i]]);
-        totalWeight += graph[i][parent[i]];
+    long long totalWeight = 0;
+    for (int i = 0; i < V; i++) {
+        if (parent[i] == -1)
+            continue;  // Root of a tree
+        printf("%d - %d \t\t%d\n", parent[i], i, key[i]);
+        totalWeight += key[i];
     }
-    printf("\nTotal weight of MST: %d\n", totalWeight);
+    printf("\nTotal weight of MST: %lld\n", totalWeight);
 }
 
-// Function to construct and print MST for a graph represented using adjacency matrix
-void primMST(int graph[V][V]) {
-    int parent[V];    // Array to store constructed MST
-    int key[V];       // Key values used to pick minimum weight edge in cut
-    bool mstSet[V];   // To represent set of vertices included in MST
-    
+// Function to construct the MST of a graph represented using adjacency matrix
+// Fills parent[] and key[] and returns the total weight (O(V^2))
+long long primMatrix(int V, int graph[V][V], int parent[], int key[]) {
+    bool* mstSet = (bool*)malloc(V * sizeof(bool)); // To represent set of vertices included in MST
+
     // Initialize all keys as INFINITE
     for (int i = 0; i < V; i++) {
         key[i] = INT_MAX;
         mstSet[i] = false;
+        parent[i] = -1;
     }
-    
+
     // Always include first vertex in MST
     // Make key 0 so that this vertex is picked as first vertex
     key[0] = 0;
     parent[0] = -1;  // First node is always root of MST
-    
+
     // The MST will have V vertices
-    for (int count = 0; count < V - 1; count++) {
+    long long totalWeight = 0;
+    for (int count = 0; count < V; count++) {
         // Pick the minimum key vertex from the set of vertices not yet included in MST
-        int u = minKey(key, mstSet);
-        
+        int u = minKey(V, key, mstSet);
+        if (u == -1)
+            break;  // The rest of the graph is not connected to vertex 0
+
         // Add the picked vertex to the MST Set
         mstSet[u] = true;
-        
+        totalWeight += key[u];
+
         // Update key value and parent index of the adjacent vertices of the picked vertex
         for (int v = 0; v < V; v++) {
             // Update the key only if:
@@ -83,26 +277,760 @@ void primMST(int graph[V][V]) {
             }
         }
     }
-    
+
+    free(mstSet);
+    return totalWeight;
+}
+
+// Function to construct and print MST for a graph represented using adjacency matrix
+void primMST(int V, int graph[V][V]) {
+    int* parent = (int*)malloc(V * sizeof(int));    // Array to store constructed MST
+    int* key = (int*)malloc(V * sizeof(int));       // Key values used to pick minimum weight edge in cut
+
+    primMatrix(V, graph, parent, key);
+
     // Print the constructed MST
-    printMST(parent, graph);
+    printMST(V, parent, key);
+
+    free(parent);
+    free(key);
+}
+
+// Function to construct the minimum spanning forest of a CSR graph with the heap
+// Fills parent[] (-1 for roots) and key[] (weight of the edge to the parent)
+// and returns the total weight
+long long primHeap(const struct CSRGraph* graph, int parent[], int key[]) {
+    int n = graph->numVertices;
+    struct MinHeap* heap = createMinHeap(n, key);
+    bool* mstSet = (bool*)calloc(n, sizeof(bool));
+
+    for (int v = 0; v < n; v++) {
+        key[v] = INT_MAX;
+        parent[v] = -1;
+    }
+
+    long long totalWeight = 0;
+    for (int root = 0; root < n; root++) {
+        if (mstSet[root])
+            continue;
+
+        // Grow a new tree from the first vertex not yet spanned
+        key[root] = 0;
+        heapPushOrDecrease(heap, root);
+
+        while (heap->size > 0) {
+            // The lightest edge crossing the cut joins u to the tree
+            int u = heapExtractMin(heap);
+            mstSet[u] = true;
+            totalWeight += key[u];
+
+            // Lower the key of every neighbour outside the tree
+            for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+                int v = graph->adj[e];
+                if (!mstSet[v] && graph->weight[e] < key[v]) {
+                    key[v] = graph->weight[e];
+                    parent[v] = u;
+                    heapPushOrDecrease(heap, v);
+                }
+            }
+        }
+    }
+
+    free(mstSet);
+    freeMinHeap(heap);
+    return totalWeight;
+}
+
+// Instruction set used by the dense Prim kernels
+enum SimdLevel {
+    SIMD_SCALAR,  // Plain C, any machine
+    SIMD_SSE4,    // 4 lanes, SSE4.1
+    SIMD_AVX2     // 8 lanes, AVX2
+};
+
+// Highest instruction set supported by this CPU
+enum SimdLevel bestSimdLevel() {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return SIMD_SSE4;
+#endif
+    return SIMD_SCALAR;
+}
+
+// Name of an instruction set, for printing
+const char* simdName(enum SimdLevel level) {
+    return level == SIMD_AVX2 ? "AVX2" : level == SIMD_SSE4 ? "SSE4.1" : "scalar";
+}
+
+// One step of dense Prim: u has just joined the tree, so lower key[v] to
+// row[v] for every v outside the tree, then return the vertex outside the
+// tree with the smallest key (lowest index on ties), or -1 if every key is
+// infinite. blocked[v] is -INF outside the tree and +INF inside it, so
+// max(row[v], blocked[v]) is the candidate key without any branch.
+int denseStepFloatScalar(const float* row, float* key, const float* blocked,
+                         int* parent, int u, int n) {
+    float best = INFINITY;
+    int bestIndex = -1;
+    for (int v = 0; v < n; v++) {
+        float w = row[v] > blocked[v] ? row[v] : blocked[v];
+        if (w < key[v]) {
+            key[v] = w;
+            parent[v] = u;
+        }
+        if (key[v] < best) {
+            best = key[v];
+            bestIndex = v;
+        }
+    }
+    return bestIndex;
+}
+
+int denseStepIntScalar(const int* row, int* key, const int* blocked,
+                       int* parent, int u, int n) {
+    int best = INT_MAX;
+    int bestIndex = -1;
+    for (int v = 0; v < n; v++) {
+        int w = row[v] > blocked[v] ? row[v] : blocked[v];
+        if (w < key[v]) {
+            key[v] = w;
+            parent[v] = u;
+        }
+        if (key[v] < best) {
+            best = key[v];
+            bestIndex = v;
+        }
+    }
+    return bestIndex;
+}
+
+#ifdef HAVE_X86_SIMD
+// Pick the best of the per-lane minima, lowest index on ties
+// Lanes with index -1 never saw a finite key
+#define REDUCE_LANES(LANES, KEYS, INDICES, BEST, BEST_INDEX)                          \
+    for (int l = 0; l < LANES; l++) {                                                  \
+        if (INDICES[l] != -1 && (KEYS[l] < BEST                                        \
+                                 || (KEYS[l] == BEST && INDICES[l] < BEST_INDEX))) {   \
+            BEST = KEYS[l];                                                            \
+            BEST_INDEX = INDICES[l];                                                   \
+        }                                                                              \
+    }
+
+__attribute__((target("avx2")))
+int denseStepFloatAVX2(const float* row, float* key, const float* blocked,
+                       int* parent, int u, int n) {
+    __m256 best = _mm256_set1_ps(INFINITY);
+    __m256i bestIndex = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i from = _mm256_set1_epi32(u);
+    int v = 0;
+    for (; v + 8 <= n; v += 8) {
+        // Key update: lanes where the new edge is lighter take parent u
+        __m256 w = _mm256_max_ps(_mm256_loadu_ps(row + v), _mm256_loadu_ps(blocked + v));
+        __m256 k = _mm256_loadu_ps(key + v);
+        __m256 lower = _mm256_cmp_ps(w, k, _CMP_LT_OQ);
+        k = _mm256_min_ps(w, k);
+        _mm256_storeu_ps(key + v, k);
+        __m256i p = _mm256_loadu_si256((const __m256i*)(parent + v));
+        p = _mm256_blendv_epi8(p, from, _mm256_castps_si256(lower));
+        _mm256_storeu_si256((__m256i*)(parent + v), p);
+
+        // Running argmin per lane
+        __m256 better = _mm256_cmp_ps(k, best, _CMP_LT_OQ);
+        best = _mm256_blendv_ps(best, k, better);
+        bestIndex = _mm256_blendv_epi8(bestIndex, index, _mm256_castps_si256(better));
+        index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+    }
+
+    float keys[8];
+    int indices[8];
+    _mm256_storeu_ps(keys, best);
+    _mm256_storeu_si256((__m256i*)indices, bestIndex);
+    float bestKey = INFINITY;
+    int bestVertex = -1;
+    REDUCE_LANES(8, keys, indices, bestKey, bestVertex)
+
+    // Remaining vertices one at a time; they have higher indices than any lane
+    int tail = denseStepFloatScalar(row + v, key + v, blocked + v, parent + v, u, n - v);
+    if (tail != -1 && key[v + tail] < bestKey)
+        bestVertex = v + tail;
+    return bestVertex;
+}
+
+__attribute__((target("avx2")))
+int denseStepIntAVX2(const int* row, int* key, const int* blocked,
+                     int* parent, int u, int n) {
+    __m256i best = _mm256_set1_epi32(INT_MAX);
+    __m256i bestIndex = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i from = _mm256_set1_epi32(u);
+    int v = 0;
+    for (; v + 8 <= n; v += 8) {
+        __m256i w = _mm256_max_epi32(_mm256_loadu_si256((const __m256i*)(row + v)),
+                                     _mm256_loadu_si256((const __m256i*)(blocked + v)));
+        __m256i k = _mm256_loadu_si256((const __m256i*)(key + v));
+        __m256i lower = _mm256_cmpgt_epi32(k, w);
+        k = _mm256_min_epi32(w, k);
+        _mm256_storeu_si256((__m256i*)(key + v), k);
+        __m256i p = _mm256_loadu_si256((const __m256i*)(parent + v));
+        p = _mm256_blendv_epi8(p, from, lower);
+        _mm256_storeu_si256((__m256i*)(parent + v), p);
+
+        __m256i better = _mm256_cmpgt_epi32(best, k);
+        best = _mm256_blendv_epi8(best, k, better);
+        bestIndex = _mm256_blendv_epi8(bestIndex, index, better);
+        index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+    }
+
+    int keys[8], indices[8];
+    _mm256_storeu_si256((__m256i*)keys, best);
+    _mm256_storeu_si256((__m256i*)indices, bestIndex);
+    int bestKey = INT_MAX;
+    int bestVertex = -1;
+    REDUCE_LANES(8, keys, indices, bestKey, bestVertex)
+
+    int tail = denseStepIntScalar(row + v, key + v, blocked + v, parent + v, u, n - v);
+    if (tail != -1 && key[v + tail] < bestKey)
+        bestVertex = v + tail;
+    return bestVertex;
+}
+
+__attribute__((target("sse4.1")))
+int denseStepFloatSSE4(const float* row, float* key, const float* blocked,
+                       int* parent, int u, int n) {
+    __m128 best = _mm_set1_ps(INFINITY);
+    __m128i bestIndex = _mm_set1_epi32(-1);
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i from = _mm_set1_epi32(u);
+    int v = 0;
+    for (; v + 4 <= n; v += 4) {
+        __m128 w = _mm_max_ps(_mm_loadu_ps(row + v), _mm_loadu_ps(blocked + v));
+        __m128 k = _mm_loadu_ps(key + v);
+        __m128 lower = _mm_cmplt_ps(w, k);
+        k = _mm_min_ps(w, k);
+        _mm_storeu_ps(key + v, k);
+        __m128i p = _mm_loadu_si128((const __m128i*)(parent + v));
+        p = _mm_blendv_epi8(p, from, _mm_castps_si128(lower));
+        _mm_storeu_si128((__m128i*)(parent + v), p);
+
+        __m128 better = _mm_cmplt_ps(k, best);
+        best = _mm_blendv_ps(best, k, better);
+        bestIndex = _mm_blendv_epi8(bestIndex, index, _mm_castps_si128(better));
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+    }
+
+    float keys[4];
+    int indices[4];
+    _mm_storeu_ps(keys, best);
+    _mm_storeu_si128((__m128i*)indices, bestIndex);
+    float bestKey = INFINITY;
+    int bestVertex = -1;
+    REDUCE_LANES(4, keys, indices, bestKey, bestVertex)
+
+    int tail = denseStepFloatScalar(row + v, key + v, blocked + v, parent + v, u, n - v);
+    if (tail != -1 && key[v + tail] < bestKey)
+        bestVertex = v + tail;
+    return bestVertex;
+}
+
+__attribute__((target("sse4.1")))
+int denseStepIntSSE4(const int* row, int* key, const int* blocked,
+                     int* parent, int u, int n) {
+    __m128i best = _mm_set1_epi32(INT_MAX);
+    __m128i bestIndex = _mm_set1_epi32(-1);
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i from = _mm_set1_epi32(u);
+    int v = 0;
+    for (; v + 4 <= n; v += 4) {
+        __m128i w = _mm_max_epi32(_mm_loadu_si128((const __m128i*)(row + v)),
+                                  _mm_loadu_si128((const __m128i*)(blocked + v)));
+        __m128i k = _mm_loadu_si128((const __m128i*)(key + v));
+        __m128i lower = _mm_cmpgt_epi32(k, w);
+        k = _mm_min_epi32(w, k);
+        _mm_storeu_si128((__m128i*)(key + v), k);
+        __m128i p = _mm_loadu_si128((const __m128i*)(parent + v));
+        p = _mm_blendv_epi8(p, from, lower);
+        _mm_storeu_si128((__m128i*)(parent + v), p);
+
+        __m128i better = _mm_cmpgt_epi32(best, k);
+        best = _mm_blendv_epi8(best, k, better);
+        bestIndex = _mm_blendv_epi8(bestIndex, index, better);
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+    }
+
+    int keys[4], indices[4];
+    _mm_storeu_si128((__m128i*)keys, best);
+    _mm_storeu_si128((__m128i*)indices, bestIndex);
+    int bestKey = INT_MAX;
+    int bestVertex = -1;
+    REDUCE_LANES(4, keys, indices, bestKey, bestVertex)
+
+    int tail = denseStepIntScalar(row + v, key + v, blocked + v, parent + v, u, n - v);
+    if (tail != -1 && key[v + tail] < bestKey)
+        bestVertex = v + tail;
+    return bestVertex;
+}
+#endif
+
+// Function to construct the MST of a complete graph given as a row-major
+// n x n float matrix (matrix[u*n + v] is the weight of u - v, INFINITY means
+// no edge, the diagonal is ignored). Fills parent[] (-1 for roots) and
+// returns the total weight. O(V^2) with a single pass over each row.
+double primDenseFloat(int n, const float* matrix, int parent[], enum SimdLevel level) {
+    int (*step)(const float*, float*, const float*, int*, int, int) = denseStepFloatScalar;
+#ifdef HAVE_X86_SIMD
+    if (level == SIMD_AVX2)
+        step = denseStepFloatAVX2;
+    else if (level == SIMD_SSE4)
+        step = denseStepFloatSSE4;
+#else
+    (void)level;
+#endif
+
+    float* key = (float*)malloc(n * sizeof(float));
+    float* blocked = (float*)malloc(n * sizeof(float));
+    for (int v = 0; v < n; v++) {
+        key[v] = INFINITY;
+        blocked[v] = -INFINITY;
+        parent[v] = -1;
+    }
+
+    double totalWeight = 0;
+    int root = 0;  // Every vertex below root is already in the tree
+    int u = 0;
+    key[0] = 0;
+    for (int count = 0; count < n; count++) {
+        // u joins the tree; its key can never change again
+        totalWeight += key[u];
+        key[u] = INFINITY;
+        blocked[u] = INFINITY;
+        int next = step(matrix + (size_t)u * n, key, blocked, parent, u, n);
+        if (next == -1 && count + 1 < n) {
+            // Nothing reachable is left: start a new tree
+            while (blocked[root] == INFINITY)
+                root++;
+            next = root;
+            key[next] = 0;
+        }
+        u = next;
+    }
+
+    free(key);
+    free(blocked);
+    return totalWeight;
+}
+
+// Same as primDenseFloat() for int weights (INT_MAX means no edge)
+long long primDenseInt(int n, const int* matrix, int parent[], enum SimdLevel level) {
+    int (*step)(const int*, int*, const int*, int*, int, int) = denseStepIntScalar;
+#ifdef HAVE_X86_SIMD
+    if (level == SIMD_AVX2)
+        step = denseStepIntAVX2;
+    else if (level == SIMD_SSE4)
+        step = denseStepIntSSE4;
+#else
+    (void)level;
+#endif
+
+    int* key = (int*)malloc(n * sizeof(int));
+    int* blocked = (int*)malloc(n * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        key[v] = INT_MAX;
+        blocked[v] = INT_MIN;
+        parent[v] = -1;
+    }
+
+    long long totalWeight = 0;
+    int root = 0;
+    int u = 0;
+    key[0] = 0;
+    for (int count = 0; count < n; count++) {
+        totalWeight += key[u];
+        key[u] = INT_MAX;
+        blocked[u] = INT_MAX;
+        int next = step(matrix + (size_t)u * n, key, blocked, parent, u, n);
+        if (next == -1 && count + 1 < n) {
+            while (blocked[root] == INT_MAX)
+                root++;
+            next = root;
+            key[next] = 0;
+        }
+        u = next;
+    }
+
+    free(key);
+    free(blocked);
+    return totalWeight;
+}
+
+// Compare function for qsort to sort edges by weight
+int compareEdges(const void* a, const void* b) {
+    const struct Edge* edge1 = (const struct Edge*)a;
+    const struct Edge* edge2 = (const struct Edge*)b;
+    return (edge1->weight > edge2->weight) - (edge1->weight < edge2->weight);
+}
+
+// Kruskal's algorithm as in 3_kruskal.c, used as a reference and benchmark baseline
+// Sorts edges[] in place and returns the total weight of the spanning forest
+long long kruskalWeight(int numVertices, int numEdges, struct Edge edges[]) {
+    qsort(edges, numEdges, sizeof(struct Edge), compareEdges);
+
+    struct UnionFind* uf = createUnionFind(numVertices);
+
+    long long totalWeight = 0;
+    int taken = 0;
+    for (int i = 0; i < numEdges && taken < numVertices - 1; i++) {
+        if (!ufUnion(uf, edges[i].src, edges[i].dest))
+            continue;  // Would close a cycle
+        totalWeight += edges[i].weight;
+        taken++;
+    }
+
+    freeUnionFind(uf);
+    return totalWeight;
+}
+
+// Simple xorshift random number generator (deterministic for a given seed)
+uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Function to fill a random connected edge list: a ring through all vertices
+// plus random extra edges, weights in 1..maxWeight
+void createRandomEdges(int numVertices, int numEdges, int maxWeight, uint32_t seed,
+                       int src[], int dest[], int w[]) {
+    uint32_t state = seed;
+    for (int i = 0; i < numEdges; i++) {
+        if (i < numVertices) {
+            src[i] = i;
+            dest[i] = (i + 1) % numVertices;
+        } else {
+            src[i] = xorshift32(&state) % numVertices;
+            dest[i] = xorshift32(&state) % numVertices;
+        }
+        w[i] = 1 + xorshift32(&state) % maxWeight;
+    }
+}
+
+// Wall-clock time in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Function to check the heap version against the matrix version on a random graph
+bool checkAgainstMatrix(int n, int numEdges, uint32_t seed) {
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    int* w = (int*)malloc(numEdges * sizeof(int));
+    createRandomEdges(n, numEdges, 100, seed, src, dest, w);
+
+    // The matrix keeps the lightest of any parallel edges
+    int (*matrix)[n] = calloc((size_t)n * n, sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        if (src[i] != dest[i] && (matrix[src[i]][dest[i]] == 0 || w[i] < matrix[src[i]][dest[i]]))
+            matrix[src[i]][dest[i]] = matrix[dest[i]][src[i]] = w[i];
+    }
+
+    struct CSRGraph* graph = createCSRGraph(n, numEdges, src, dest, w);
+    int* parent = (int*)malloc(n * sizeof(int));
+    int* key = (int*)malloc(n * sizeof(int));
+    long long expected = primMatrix(n, matrix, parent, key);
+    long long actual = primHeap(graph, parent, key);
+
+    free(src);
+    free(dest);
+    free(w);
+    free(matrix);
+    free(parent);
+    free(key);
+    freeCSRGraph(graph);
+    return expected == actual;
+}
+
+// Function to compare heap Prim against matrix Prim and Kruskal on a random graph
+void benchmark(int numVertices, int numEdges, int maxWeight) {
+    int* src = (int*)malloc((size_t)numEdges * sizeof(int));
+    int* dest = (int*)malloc((size_t)numEdges * sizeof(int));
+    int* w = (int*)malloc((size_t)numEdges * sizeof(int));
+    createRandomEdges(numVertices, numEdges, maxWeight, 1, src, dest, w);
+
+    printf("Random graph: %d vertices, %d edges, weights 1..%d\n\n", numVertices, numEdges, maxWeight);
+    printf("Algorithm         Time       MST weight\n");
+
+    struct CSRGraph* graph = createCSRGraph(numVertices, numEdges, src, dest, w);
+    int* parent = (int*)malloc(numVertices * sizeof(int));
+    int* key = (int*)malloc(numVertices * sizeof(int));
+    double start = nowSeconds();
+    long long heapWeight = primHeap(graph, parent, key);
+    printf("Prim (heap)   %8.3f s   %lld\n", nowSeconds() - start, heapWeight);
+    freeCSRGraph(graph);
+
+    struct Edge* edges = (struct Edge*)malloc((size_t)numEdges * sizeof(struct Edge));
+    for (int i = 0; i < numEdges; i++) {
+        edges[i].src = src[i];
+        edges[i].dest = dest[i];
+        edges[i].weight = w[i];
+    }
+    start = nowSeconds();
+    long long kruskal = kruskalWeight(numVertices, numEdges, edges);
+    printf("Kruskal       %8.3f s   %lld %s\n", nowSeconds() - start, kruskal,
+           kruskal == heapWeight ? "" : "WEIGHTS DIFFER");
+    free(edges);
+
+    if (numVertices <= MAX_MATRIX_VERTICES) {
+        int (*matrix)[numVertices] = calloc((size_t)numVertices * numVertices, sizeof(int));
+        for (int i = 0; i < numEdges; i++) {
+            int u = src[i], v = dest[i];
+            if (u != v && (matrix[u][v] == 0 || w[i] < matrix[u][v]))
+                matrix[u][v] = matrix[v][u] = w[i];
+        }
+        start = nowSeconds();
+        long long matrixWeight = primMatrix(numVertices, matrix, parent, key);
+        printf("Prim (matrix) %8.3f s   %lld %s\n", nowSeconds() - start, matrixWeight,
+               matrixWeight == heapWeight ? "" : "WEIGHTS DIFFER");
+        free(matrix);
+    } else {
+        printf("Prim (matrix) skipped, more than %d vertices\n", MAX_MATRIX_VERTICES);
+    }
+
+    free(parent);
+    free(key);
+    free(src);
+    free(dest);
+    free(w);
+}
+
+// Function to fill an n x n row-major matrix with the Manhattan distances
+// between n random points, as a float and as an int matrix (weights >= 1)
+void createDistanceMatrices(int n, uint32_t seed, float* floatMatrix, int* intMatrix) {
+    uint32_t state = seed;
+    float* x = (float*)malloc(n * sizeof(float));
+    float* y = (float*)malloc(n * sizeof(float));
+    for (int i = 0; i < n; i++) {
+        x[i] = (xorshift32(&state) % 1000000) / 1000.0f;
+        y[i] = (xorshift32(&state) % 1000000) / 1000.0f;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            float dx = x[i] > x[j] ? x[i] - x[j] : x[j] - x[i];
+            float dy = y[i] > y[j] ? y[i] - y[j] : y[j] - y[i];
+            floatMatrix[(size_t)i * n + j] = dx + dy;
+            intMatrix[(size_t)i * n + j] = 1 + (int)((dx + dy) * 1000);
+        }
+    }
+    free(x);
+    free(y);
+}
+
+// Function to check every dense kernel against the heap version (which
+// handles forests) on a complete graph and on one split into two halves
+bool checkDense(int n, uint32_t seed) {
+    float* floatMatrix = (float*)malloc((size_t)n * n * sizeof(float));
+    int* intMatrix = (int*)malloc((size_t)n * n * sizeof(int));
+    int* parent = (int*)malloc(n * sizeof(int));
+    int* key = (int*)malloc(n * sizeof(int));
+    int* src = (int*)malloc((size_t)n * n / 2 * sizeof(int));
+    int* dest = (int*)malloc((size_t)n * n / 2 * sizeof(int));
+    int* w = (int*)malloc((size_t)n * n / 2 * sizeof(int));
+    createDistanceMatrices(n, seed, floatMatrix, intMatrix);
+    bool ok = true;
+
+    for (int split = 0; split < 2; split++) {
+        if (split) {
+            // Remove every edge between the first and the second half
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < n; j++) {
+                    if ((i < n / 2) != (j < n / 2)) {
+                        floatMatrix[(size_t)i * n + j] = INFINITY;
+                        intMatrix[(size_t)i * n + j] = INT_MAX;
+                    }
+                }
+            }
+        }
+
+        int numEdges = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                if (intMatrix[(size_t)i * n + j] != INT_MAX) {
+                    src[numEdges] = i;
+                    dest[numEdges] = j;
+                    w[numEdges] = intMatrix[(size_t)i * n + j];
+                    numEdges++;
+                }
+            }
+        }
+        struct CSRGraph* graph = createCSRGraph(n, numEdges, src, dest, w);
+        long long expected = primHeap(graph, parent, key);
+        freeCSRGraph(graph);
+
+        double floatExpected = primDenseFloat(n, floatMatrix, parent, SIMD_SCALAR);
+        for (int level = SIMD_SCALAR; level <= (int)bestSimdLevel(); level++) {
+            ok = ok && primDenseInt(n, intMatrix, parent, (enum SimdLevel)level) == expected;
+            ok = ok && primDenseFloat(n, floatMatrix, parent, (enum SimdLevel)level) == floatExpected;
+        }
+    }
+
+    free(floatMatrix);
+    free(intMatrix);
+    free(parent);
+    free(key);
+    free(src);
+    free(dest);
+    free(w);
+    return ok;
+}
+
+// Function to time dense Prim on the distance matrix of n random points
+void benchmarkDense(int n) {
+    float* floatMatrix = (float*)malloc((size_t)n * n * sizeof(float));
+    int* intMatrix = (int*)malloc((size_t)n * n * sizeof(int));
+    int* parent = (int*)malloc(n * sizeof(int));
+    int* key = (int*)malloc(n * sizeof(int));
+    createDistanceMatrices(n, 1, floatMatrix, intMatrix);
+    printf("Complete graph on %d random points (%d x %d matrix)\n\n", n, n, n);
+    printf("Version            Time       MST weight\n");
+
+    double start = nowSeconds();
+    long long expected = primMatrix(n, (int (*)[n])intMatrix, parent, key);
+    printf("original (int)  %8.3f s   %lld\n", nowSeconds() - start, expected);
+
+    for (int level = SIMD_SCALAR; level <= (int)bestSimdLevel(); level++) {
+        start = nowSeconds();
+        long long weight = primDenseInt(n, intMatrix, parent, (enum SimdLevel)level);
+        printf("%-6s (int)    %8.3f s   %lld %s\n", simdName((enum SimdLevel)level), nowSeconds() - start,
+               weight, weight == expected ? "" : "WEIGHTS DIFFER");
+    }
+    for (int level = SIMD_SCALAR; level <= (int)bestSimdLevel(); level++) {
+        start = nowSeconds();
+        double weight = primDenseFloat(n, floatMatrix, parent, (enum SimdLevel)level);
+        printf("%-6s (float)  %8.3f s   %.3f\n", simdName((enum SimdLevel)level), nowSeconds() - start, weight);
+    }
+
+    free(floatMatrix);
+    free(intMatrix);
+    free(parent);
+    free(key);
+}
+
+// Function to load a graph file as a CSR graph and run Prim on it
+// An undirected file already stores both directions and is used in place;
+// a directed file is treated as undirected by adding the reverse edges
+bool primFromFile(const char* path) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return false;
+    int n = file->numVertices;
+
+    struct CSRGraph* graph;
+    if (!file->directed) {
+        graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+        graph->numVertices = n;
+        graph->numEdges = file->numEdges;
+        graph->rowStart = file->rowStart;
+        graph->adj = file->adj;
+        graph->weight = file->weight;
+    } else {
+        int* src = (int*)malloc((size_t)file->numEdges * sizeof(int));
+        for (int u = 0; u < n; u++)
+            for (int e = file->rowStart[u]; e < file->rowStart[u + 1]; e++)
+                src[e] = u;
+        graph = createCSRGraph(n, file->numEdges, src, file->adj, file->weight);
+        free(src);
+    }
+
+    int* parent = (int*)malloc(n * sizeof(int));
+    int* key = (int*)malloc(n * sizeof(int));
+    printf("Loaded %s: %d vertices\n\n", path, n);
+    double start = nowSeconds();
+    long long totalWeight = primHeap(graph, parent, key);
+    double elapsed = nowSeconds() - start;
+    if (n <= 20)
+        printMST(n, parent, key);
+    else
+        printf("Total weight of MST: %lld (%.3f s)\n", totalWeight, elapsed);
+
+    if (file->directed)
+        freeCSRGraph(graph);
+    else
+        free(graph);  // The arrays belong to the mapping
+    closeGraphFile(file);
+    free(parent);
+    free(key);
+    return true;
 }
 
 // Driver program to test above functions
-int main() {
+// Usage: ./2_prims [graphFile]
+//        ./2_prims bench [V] [E] [maxWeight]
+//        ./2_prims bench-dense [V]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "bench-dense") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 8000;
+        if (numVertices < 1 || numVertices > 40000) {
+            printf("Dense benchmark needs 1 <= V <= 40000\n");
+            return 1;
+        }
+        benchmarkDense(numVertices);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 1000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 10000000;
+        int maxWeight = argc > 4 ? atoi(argv[4]) : 1000;
+        if (numVertices < 1 || numEdges < numVertices || numEdges > INT_MAX / 2 || maxWeight < 1) {
+            printf("Benchmark needs V >= 1, V <= E <= %d and maxWeight >= 1\n", INT_MAX / 2);
+            return 1;
+        }
+        benchmark(numVertices, numEdges, maxWeight);
+        return 0;
+    }
+
+    if (argc > 1) {
+        printf("Prim's Minimum Spanning Tree Algorithm\n");
+        printf("=======================================\n\n");
+        return primFromFile(argv[1]) ? 0 : 1;
+    }
+
     /* Example graph represented as adjacency matrix */
-    int graph[V][V] = {
+    int graph[5][5] = {
         {0, 2, 0, 6, 0},
         {2, 0, 3, 8, 5},
         {0, 3, 0, 0, 7},
         {6, 8, 0, 0, 9},
         {0, 5, 7, 9, 0}
     };
-    
+
     printf("Prim's Minimum Spanning Tree Algorithm\n");
     printf("=======================================\n\n");
-    
-    primMST(graph);
-    
+
+    primMST(5, graph);
+
+    // The same graph as an edge list, solved with the heap on CSR
+    int src[7] = {0, 0, 1, 1, 1, 2, 3};
+    int dest[7] = {1, 3, 2, 3, 4, 4, 4};
+    int w[7] = {2, 6, 3, 8, 5, 7, 9};
+    struct CSRGraph* csr = createCSRGraph(5, 7, src, dest, w);
+    int parent[5], key[5];
+    printf("\nHeap-based Prim on the same graph in CSR form:\n");
+    primHeap(csr, parent, key);
+    printMST(5, parent, key);
+    freeCSRGraph(csr);
+
+    // Cross-check the heap version against the O(V^2) matrix version
+    printf("\nChecking heap-based Prim against adjacency-matrix version: %s\n",
+           checkAgainstMatrix(300, 1500, 42) && checkAgainstMatrix(50, 50, 7) ? "PASSED" : "FAILED");
+    printf("Checking dense %s kernels against heap-based Prim: %s\n", simdName(bestSimdLevel()),
+           checkDense(101, 3) && checkDense(64, 5) && checkDense(7, 9) ? "PASSED" : "FAILED");
+
     return 0;
 }
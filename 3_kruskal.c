@@ -9,10 +9,76 @@
  * 3. Repeat step 2 until there are (V-1) edges in the spanning tree
  * 
  * Note: Uses Union-Find (Disjoint Set) data structure to detect cycles
+ * (union_find.h)
+ *
+ * Sorting every edge dominates the running time on large graphs. Two faster
+ * modes are available besides qsort():
+ * - Radix sort: edges are sorted by weight one byte at a time (LSD radix
+ *   sort). Each thread counts the bytes of its share of the edges, the
+ *   counts give every thread its own output positions, and the threads then
+ *   move their edges in parallel. Time Complexity: O(E) per byte of weight
+ * - Filter-Kruskal (Osipov, Sanders and Singler):
+ *    a. If few edges are left, radix sort them and run plain Kruskal
+ *    b. Otherwise pick a pivot weight (median of a sample) and partition the
+ *       edges into light (weight <= pivot) and heavy ones
+ *    c. Recurse on the light edges first
+ *    d. Drop every heavy edge whose endpoints are now in the same
+ *       component, then recurse on the heavy edges that are left
+ *   Heavy edges inside a component are never sorted, which on random graphs
+ *   removes most of the sorting work.
+ *
+ * Key-only Kruskal keeps the edges in a compact store: the endpoints sit in
+ * their own src[] and dest[] arrays, and weight and edge index are packed
+ * into one 64-bit key (weight << 32 | index, with the sign bit of the weight
+ * flipped so negative weights sort first). Sorting the keys is a plain
+ * LSD radix sort on the four weight bytes with no comparator calls, and it
+ * moves 8 bytes per edge instead of 12. The scan then reads src[index] and
+ * dest[index] only for the keys it reaches before the tree is complete.
+ *
+ * Borůvka's algorithm needs no sorting and parallelises across threads:
+ *    a. Every component picks its lightest outgoing edge (all threads scan
+ *       their share of the edges and lower best[component] atomically)
+ *    b. All picked edges are added at once, merging components through the
+ *       concurrent union-find, which links roots with compare-and-swap
+ *    c. Edges inside one component are dropped; repeat until no component
+ *       has an outgoing edge
+ * Every round at least halves the number of components, so there are at
+ * most log V rounds. Equal weights are ordered by edge position, which
+ * keeps the picked edges free of cycles; the weight matches Kruskal's.
+ * Time Complexity: O(E log V / threads) for the rounds
+ *
+ * Streaming Kruskal keeps only the current spanning forest and one batch
+ * of edges in memory, so the edge list may be larger than RAM:
+ *    a. Collect up to B incoming edges into a batch
+ *    b. Radix sort the batch; the forest is already sorted by weight
+ *    c. Merge the two sorted lists and run Kruskal on the merged order with
+ *       a fresh union-find; the accepted edges are the new forest
+ *    d. Repeat for the next batch
+ * An edge dropped in step c is the heaviest edge of a cycle among the
+ * edges seen so far, so it is in no MST of any later superset of them.
+ * Memory: O(V + B). Time Complexity: O(V + B) per batch after the sort
+ *
+ * The graph can also be read from a graph file (see graph_file.h). An
+ * undirected file stores each edge in both directions; only the u < v copy
+ * is kept, so every edge is sorted once.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "graph_file.h"
+#include "union_find.h"
+
+#define RADIX_MIN_EDGES_PER_THREAD 65536  // Smaller sorts run on one thread
+#define FILTER_MIN_EDGES 4096             // Filter-Kruskal sorts directly below this
+#define PIVOT_SAMPLES 63                  // Sample size for the pivot median
+#define STREAM_BATCH_EDGES (1 << 20)      // Default batch size of streaming Kruskal
 
 // Structure to represent an edge in the graph
 struct Edge {
@@ -25,10 +91,27 @@ struct Graph {
     struct Edge* edge;  // Array of edges
 };
 
-// Structure to represent a subset for union-find
-struct subset {
-    int parent;
-    int rank;
+// How the spanning tree is computed (the first three differ in how the
+// edges are brought into weight order)
+enum MSTMode {
+    QSORT_KRUSKAL,   // qsort() with compareEdges
+    RADIX_KRUSKAL,   // Parallel LSD radix sort on the weight
+    FILTER_KRUSKAL,  // Filter-Kruskal with radix-sorted base cases
+    BORUVKA_MST,     // Parallel Borůvka, no sorting at all
+    STREAM_KRUSKAL,  // Edges fed in batches to a streaming Kruskal
+    KEY_KRUSKAL      // Radix sort of packed (weight, index) keys only
+};
+
+#define NUM_MODES (KEY_KRUSKAL + 1)
+
+// Work of one thread in the parallel radix sort
+struct RadixThread {
+    const struct Edge* src;
+    struct Edge* dest;
+    int begin, end;        // This thread's share of the edges
+    int shift;             // Byte being sorted in a scatter pass
+    int count[4][256];     // Histogram of each weight byte in the share
+    int offset[256];       // Next output position for each byte value
 };
 
 // Function to create a graph with V vertices and E edges
@@ -40,88 +123,789 @@ struct Graph* createGraph(int V, int E) {
     return graph;
 }
 
-// Find set of an element i (uses path compression technique)
-int find(struct subset subsets[], int i) {
-    if (subsets[i].parent != i)
-        subsets[i].parent = find(subsets, subsets[i].parent);
-    return subsets[i].parent;
-}
-
-// Function to perform union of two sets x and y (uses union by rank)
-void Union(struct subset subsets[], int x, int y) {
-    int xroot = find(subsets, x);
-    int yroot = find(subsets, y);
-    
-    // Attach smaller rank tree under root of high rank tree
-    if (subsets[xroot].rank < subsets[yroot].rank)
-        subsets[xroot].parent = yroot;
-    else if (subsets[xroot].rank > subsets[yroot].rank)
-        subsets[yroot].parent = xroot;
-    else {
-        // If ranks are same, make one as root and increment its rank
-        subsets[yroot].parent = xroot;
-        subsets[xroot].rank++;
-    }
-}
-
 // Compare function for qsort to sort edges by weight
+// (comparing instead of subtracting, which could overflow)
 int compareEdges(const void* a, const void* b) {
     struct Edge* edge1 = (struct Edge*)a;
     struct Edge* edge2 = (struct Edge*)b;
-    return edge1->weight - edge2->weight;
+    return (edge1->weight > edge2->weight) - (edge1->weight < edge2->weight);
 }
 
-// Function to construct MST using Kruskal's algorithm
-void KruskalMST(struct Graph* graph) {
-    int V = graph->V;
-    struct Edge result[V];  // This will store the resultant MST
-    int e = 0;  // Index variable for result[]
+// Unsigned key that sorts like the signed weight: flipping the sign bit
+// moves negative weights below all non-negative ones. Small non-negative
+// weights still share their top byte, so radix passes over it are skipped
+static inline uint32_t weightKey(int weight) {
+    return (uint32_t)weight ^ 0x80000000u;
+}
+
+// Function to add edges, in sorted order, to the forest kept in uf
+// Accepted edges are appended to result[]; returns the new number of edges
+int kruskalScan(int V, struct UnionFind* uf, const struct Edge edges[], int numEdges,
+                struct Edge result[], int e) {
     int i = 0;  // Index variable for sorted edges
     
-    // Step 1: Sort all the edges in non-decreasing order of their weight
-    qsort(graph->edge, graph->E, sizeof(graph->edge[0]), compareEdges);
-    
-    // Allocate memory for creating V subsets
-    struct subset* subsets = (struct subset*)malloc(V * sizeof(struct subset));
-    
-    // Create V subsets with single elements
-    for (int v = 0; v < V; v++) {
-        subsets[v].parent = v;
-        subsets[v].rank = 0;
-    }
-    
     // Number of edges to be taken is equal to V-1
-    while (e < V - 1 && i < graph->E) {
+    while (e < V - 1 && i < numEdges) {
         // Step 2: Pick the smallest edge and increment the index for next iteration
-        struct Edge next_edge = graph->edge[i++];
-        
-        int x = find(subsets, next_edge.src);
-        int y = find(subsets, next_edge.dest);
+        struct Edge next_edge = edges[i++];
         
         // If including this edge doesn't cause cycle, include it in result
         // and increment the index of result for next edge
-        if (x != y) {
+        if (ufUnion(uf, next_edge.src, next_edge.dest))
             result[e++] = next_edge;
-            Union(subsets, x, y);
-        }
         // Else discard the next_edge (it would create a cycle)
     }
+    return e;
+}
+
+// Count the four weight bytes of one thread's edges
+void* radixCountWorker(void* arg) {
+    struct RadixThread* t = (struct RadixThread*)arg;
+    memset(t->count, 0, sizeof(t->count));
+    for (int i = t->begin; i < t->end; i++) {
+        uint32_t w = weightKey(t->src[i].weight);
+        t->count[0][w & 0xff]++;
+        t->count[1][(w >> 8) & 0xff]++;
+        t->count[2][(w >> 16) & 0xff]++;
+        t->count[3][w >> 24]++;
+    }
+    return NULL;
+}
+
+// Move one thread's edges to their positions for the current byte
+void* radixScatterWorker(void* arg) {
+    struct RadixThread* t = (struct RadixThread*)arg;
+    for (int i = t->begin; i < t->end; i++) {
+        int digit = (weightKey(t->src[i].weight) >> t->shift) & 0xff;
+        t->dest[t->offset[digit]++] = t->src[i];
+    }
+    return NULL;
+}
+
+// Run worker on every thread description and wait for all of them
+void runThreads(int numThreads, void* (*worker)(void*), struct RadixThread threads[]) {
+    pthread_t* ids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&ids[t], NULL, worker, &threads[t]);
+    worker(&threads[0]);  // The calling thread takes the first share
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(ids[t], NULL);
+    free(ids);
+}
+
+// Function to sort edges by weight with a parallel LSD radix sort on
+// weightKey(); scratch[] must hold numEdges edges. The sort is stable.
+void radixSortEdges(struct Edge edges[], int numEdges, struct Edge scratch[], int numThreads) {
+    if (numThreads > numEdges / RADIX_MIN_EDGES_PER_THREAD)
+        numThreads = numEdges / RADIX_MIN_EDGES_PER_THREAD;
+    if (numThreads < 1)
+        numThreads = 1;
+    
+    struct RadixThread* threads = (struct RadixThread*)malloc(numThreads * sizeof(struct RadixThread));
+    for (int t = 0; t < numThreads; t++) {
+        threads[t].begin = (int)((long long)numEdges * t / numThreads);
+        threads[t].end = (int)((long long)numEdges * (t + 1) / numThreads);
+    }
+    
+    // The byte histograms of all edges decide which passes are needed:
+    // a byte that is the same in every weight is skipped
+    for (int t = 0; t < numThreads; t++)
+        threads[t].src = edges;
+    runThreads(numThreads, radixCountWorker, threads);
+    bool needed[4];
+    for (int pass = 0; pass < 4; pass++) {
+        needed[pass] = true;
+        for (int digit = 0; digit < 256; digit++) {
+            int total = 0;
+            for (int t = 0; t < numThreads; t++)
+                total += threads[t].count[pass][digit];
+            if (total == numEdges)
+                needed[pass] = false;
+        }
+    }
+    
+    struct Edge* from = edges;
+    struct Edge* to = scratch;
+    bool countsValid = true;  // Per-thread counts match the order of from[]
+    for (int pass = 0; pass < 4; pass++) {
+        if (!needed[pass])
+            continue;
+        if (!countsValid) {
+            for (int t = 0; t < numThreads; t++)
+                threads[t].src = from;
+            runThreads(numThreads, radixCountWorker, threads);
+        }
+        
+        // Edges with a smaller byte go first; for equal bytes, lower
+        // threads go first, which keeps the sort stable
+        int position = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            for (int t = 0; t < numThreads; t++) {
+                threads[t].offset[digit] = position;
+                position += threads[t].count[pass][digit];
+            }
+        }
+        for (int t = 0; t < numThreads; t++) {
+            threads[t].src = from;
+            threads[t].dest = to;
+            threads[t].shift = 8 * pass;
+        }
+        runThreads(numThreads, radixScatterWorker, threads);
+        
+        // The output of this pass is the input of the next one
+        struct Edge* tmp = from;
+        from = to;
+        to = tmp;
+        countsValid = false;
+    }
+    
+    if (from != edges)
+        memcpy(edges, from, numEdges * sizeof(struct Edge));
+    free(threads);
+}
+
+// Function to choose a pivot weight: the median of evenly spaced samples
+int choosePivot(const struct Edge edges[], int numEdges) {
+    int sample[PIVOT_SAMPLES];
+    for (int i = 0; i < PIVOT_SAMPLES; i++)
+        sample[i] = edges[(long long)numEdges * i / PIVOT_SAMPLES].weight;
+    
+    // Insertion sort of the small sample
+    for (int i = 1; i < PIVOT_SAMPLES; i++) {
+        int w = sample[i], j = i - 1;
+        while (j >= 0 && sample[j] > w) {
+            sample[j + 1] = sample[j];
+            j--;
+        }
+        sample[j + 1] = w;
+    }
+    return sample[PIVOT_SAMPLES / 2];
+}
+
+// Filter-Kruskal on edges[0 .. numEdges-1], extending the forest in uf
+// Returns the new number of edges in result[]
+int filterKruskal(int V, struct UnionFind* uf, struct Edge edges[], int numEdges,
+                  struct Edge scratch[], struct Edge result[], int e, int numThreads) {
+    if (e == V - 1 || numEdges == 0)
+        return e;
+    
+    // Partition around the pivot: light edges to the front
+    int light = 0;
+    if (numEdges > FILTER_MIN_EDGES) {
+        int pivot = choosePivot(edges, numEdges);
+        for (int i = 0; i < numEdges; i++) {
+            if (edges[i].weight <= pivot) {
+                struct Edge tmp = edges[i];
+                edges[i] = edges[light];
+                edges[light++] = tmp;
+            }
+        }
+    }
+    
+    // Few edges, or every weight on one side of the pivot: sort directly
+    if (light == 0 || light == numEdges) {
+        radixSortEdges(edges, numEdges, scratch, numThreads);
+        return kruskalScan(V, uf, edges, numEdges, result, e);
+    }
+    
+    e = filterKruskal(V, uf, edges, light, scratch, result, e, numThreads);
+    
+    // Filter: keep only heavy edges that still join two components
+    struct Edge* heavy = edges + light;
+    int kept = 0;
+    for (int i = 0; i < numEdges - light; i++)
+        if (!ufConnected(uf, heavy[i].src, heavy[i].dest))
+            heavy[kept++] = heavy[i];
+    
+    return filterKruskal(V, uf, heavy, kept, scratch, result, e, numThreads);
+}
+
+// Compact edge store for key-only Kruskal
+struct CompactEdges {
+    int E;
+    uint64_t* key;   // (weightKey << 32) | index, sorted by the key-only mode
+    int* src;        // Endpoints of edge index
+    int* dest;
+};
+
+// Function to build the compact store of the edges of graph
+struct CompactEdges* createCompactEdges(const struct Graph* graph) {
+    struct CompactEdges* c = (struct CompactEdges*)malloc(sizeof(struct CompactEdges));
+    c->E = graph->E;
+    c->key = (uint64_t*)malloc(graph->E * sizeof(uint64_t));
+    c->src = (int*)malloc(graph->E * sizeof(int));
+    c->dest = (int*)malloc(graph->E * sizeof(int));
+    for (int i = 0; i < graph->E; i++) {
+        c->key[i] = (uint64_t)weightKey(graph->edge[i].weight) << 32 | (uint32_t)i;
+        c->src[i] = graph->edge[i].src;
+        c->dest[i] = graph->edge[i].dest;
+    }
+    return c;
+}
+
+void freeCompactEdges(struct CompactEdges* c) {
+    free(c->key);
+    free(c->src);
+    free(c->dest);
+    free(c);
+}
+
+// Function to sort keys by their upper 32 bits (the weight) with an LSD
+// radix sort; scratch[] must hold n keys. The sort is stable, so keys
+// built in index order stay in index order for equal weights
+void radixSortKeys(uint64_t keys[], int n, uint64_t scratch[]) {
+    int count[4][256] = { { 0 } };
+    for (int i = 0; i < n; i++) {
+        uint32_t w = (uint32_t)(keys[i] >> 32);
+        count[0][w & 0xff]++;
+        count[1][(w >> 8) & 0xff]++;
+        count[2][(w >> 16) & 0xff]++;
+        count[3][w >> 24]++;
+    }
+    
+    uint64_t* from = keys;
+    uint64_t* to = scratch;
+    for (int pass = 0; pass < 4; pass++) {
+        int shift = 32 + 8 * pass;
+        if (count[pass][(from[0] >> shift) & 0xff] == n)
+            continue;  // Same byte in every key
+        int offset[256], position = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            offset[digit] = position;
+            position += count[pass][digit];
+        }
+        for (int i = 0; i < n; i++)
+            to[offset[(from[i] >> shift) & 0xff]++] = from[i];
+        uint64_t* tmp = from;
+        from = to;
+        to = tmp;
+    }
+    if (from != keys)
+        memcpy(keys, from, n * sizeof(uint64_t));
+}
+
+// Function to run Kruskal on the compact store, sorting only the keys
+// Returns the number of edges in result[]
+int keyKruskal(int V, struct CompactEdges* c, struct Edge result[]) {
+    if (c->E == 0)
+        return 0;
+    uint64_t* scratch = (uint64_t*)malloc(c->E * sizeof(uint64_t));
+    radixSortKeys(c->key, c->E, scratch);
+    free(scratch);
+    
+    struct UnionFind* uf = createUnionFind(V);
+    int e = 0;
+    for (int i = 0; i < c->E && e < V - 1; i++) {
+        uint32_t index = (uint32_t)c->key[i];
+        if (ufUnion(uf, c->src[index], c->dest[index])) {
+            result[e].src = c->src[index];
+            result[e].dest = c->dest[index];
+            result[e].weight = (int)((uint32_t)(c->key[i] >> 32) ^ 0x80000000u);  // Undo weightKey()
+            e++;
+        }
+    }
+    freeUnionFind(uf);
+    return e;
+}
+
+// State shared by the threads of parallel Borůvka
+struct Boruvka {
+    int V;
+    struct Edge* edges;            // Working copy, compacted every round
+    struct ConcurrentUnionFind* uf;
+    int* label;                    // Root of every vertex at the start of a round
+    _Atomic uint64_t* best;        // best[root] = (weightKey << 32) | position of its lightest edge
+    struct Edge* result;
+    atomic_int numResult;
+    atomic_int merged[2];          // Unions in the current round (by round parity)
+    pthread_barrier_t barrier;
+};
+
+// One thread of parallel Borůvka: a fixed share of the edges and vertices
+struct BoruvkaThread {
+    struct Boruvka* shared;
+    int edgeBegin, edgeCount;      // Edges of the share still crossing components
+    int vertexBegin, vertexEnd;
+};
+
+#define NO_EDGE UINT64_MAX
+
+// Lower *target to value if value is smaller
+void atomicMin64(_Atomic uint64_t* target, uint64_t value) {
+    uint64_t current = atomic_load_explicit(target, memory_order_relaxed);
+    while (value < current
+           && !atomic_compare_exchange_weak_explicit(target, &current, value,
+                                                     memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+// Rounds of Borůvka on one thread; barriers separate the phases of a round
+void* boruvkaWorker(void* arg) {
+    struct BoruvkaThread* t = (struct BoruvkaThread*)arg;
+    struct Boruvka* b = t->shared;
+    struct Edge* edges = b->edges + t->edgeBegin;
+
+    for (int round = 0; ; round++) {
+        // 1. Every edge offers itself to both of its components; ties are
+        //    broken by position, so all components agree on one order
+        for (int i = 0; i < t->edgeCount; i++) {
+            uint64_t key = (uint64_t)weightKey(edges[i].weight) << 32 | (uint32_t)(t->edgeBegin + i);
+            atomicMin64(&b->best[b->label[edges[i].src]], key);
+            atomicMin64(&b->best[b->label[edges[i].dest]], key);
+        }
+        pthread_barrier_wait(&b->barrier);
+
+        // 2. Every component adds its lightest edge. Two components may pick
+        //    the same edge; only the first union succeeds and records it
+        int merged = 0;
+        for (int v = t->vertexBegin; v < t->vertexEnd; v++) {
+            uint64_t key = atomic_load_explicit(&b->best[v], memory_order_relaxed);
+            if (key == NO_EDGE)
+                continue;
+            struct Edge edge = b->edges[(uint32_t)key];
+            if (cufUnion(b->uf, edge.src, edge.dest)) {
+                b->result[atomic_fetch_add(&b->numResult, 1)] = edge;
+                merged++;
+            }
+        }
+        atomic_fetch_add(&b->merged[round & 1], merged);
+        pthread_barrier_wait(&b->barrier);
+
+        // 3. Relabel every vertex with its new root
+        for (int v = t->vertexBegin; v < t->vertexEnd; v++) {
+            b->label[v] = cufFind(b->uf, v);
+            atomic_store_explicit(&b->best[v], NO_EDGE, memory_order_relaxed);
+        }
+        if (t->vertexBegin == 0)
+            atomic_store(&b->merged[(round + 1) & 1], 0);
+        pthread_barrier_wait(&b->barrier);
+
+        if (atomic_load(&b->merged[round & 1]) == 0)
+            return NULL;  // No component has an outgoing edge left
+
+        // 4. Drop edges inside a component from this thread's share
+        int kept = 0;
+        for (int i = 0; i < t->edgeCount; i++)
+            if (b->label[edges[i].src] != b->label[edges[i].dest])
+                edges[kept++] = edges[i];
+        t->edgeCount = kept;
+    }
+}
+
+// Function to compute a minimum spanning forest with parallel Borůvka
+// Returns the number of edges in result[]; graph is not modified
+int boruvkaForest(const struct Graph* graph, struct Edge result[], int numThreads) {
+    struct Boruvka b;
+    b.V = graph->V;
+    b.edges = (struct Edge*)malloc(graph->E * sizeof(struct Edge));
+    memcpy(b.edges, graph->edge, graph->E * sizeof(struct Edge));
+    b.uf = createConcurrentUnionFind(graph->V);
+    b.label = (int*)malloc(graph->V * sizeof(int));
+    b.best = (_Atomic uint64_t*)malloc(graph->V * sizeof(_Atomic uint64_t));
+    for (int v = 0; v < graph->V; v++) {
+        b.label[v] = v;
+        atomic_init(&b.best[v], NO_EDGE);
+    }
+    b.result = result;
+    atomic_init(&b.numResult, 0);
+    atomic_init(&b.merged[0], 0);
+    atomic_init(&b.merged[1], 0);
+    pthread_barrier_init(&b.barrier, NULL, numThreads);
+
+    struct BoruvkaThread* threads = (struct BoruvkaThread*)malloc(numThreads * sizeof(struct BoruvkaThread));
+    pthread_t* ids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        threads[t].shared = &b;
+        threads[t].edgeBegin = (int)((long long)graph->E * t / numThreads);
+        threads[t].edgeCount = (int)((long long)graph->E * (t + 1) / numThreads) - threads[t].edgeBegin;
+        threads[t].vertexBegin = (int)((long long)graph->V * t / numThreads);
+        threads[t].vertexEnd = (int)((long long)graph->V * (t + 1) / numThreads);
+    }
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&ids[t], NULL, boruvkaWorker, &threads[t]);
+    boruvkaWorker(&threads[0]);
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(ids[t], NULL);
+
+    int numResult = atomic_load(&b.numResult);
+    pthread_barrier_destroy(&b.barrier);
+    free(threads);
+    free(ids);
+    free(b.edges);
+    freeConcurrentUnionFind(b.uf);
+    free(b.label);
+    free((void*)b.best);
+    return numResult;
+}
+
+// Spanning forest of the edges seen so far, extended one batch at a time
+struct StreamingMST {
+    int V;
+    int batchCapacity;
+    int numThreads;          // Threads for the radix sort of a batch
+    struct Edge* forest;     // Current forest, sorted by weight
+    int forestSize;
+    struct Edge* merged;     // Next forest is built here, then swapped in
+    struct Edge* batch;      // Edges received since the last merge
+    int batchSize;
+    struct Edge* scratch;    // Radix sort buffer for the batch
+    struct UnionFind* uf;
+    long long edgesSeen;
+};
+
+// Function to create an empty streaming MST over V vertices
+struct StreamingMST* createStreamingMST(int V, int batchCapacity, int numThreads) {
+    struct StreamingMST* s = (struct StreamingMST*)malloc(sizeof(struct StreamingMST));
+    s->V = V;
+    s->batchCapacity = batchCapacity;
+    s->numThreads = numThreads;
+    s->forest = (struct Edge*)malloc(V * sizeof(struct Edge));
+    s->forestSize = 0;
+    s->merged = (struct Edge*)malloc(V * sizeof(struct Edge));
+    s->batch = (struct Edge*)malloc(batchCapacity * sizeof(struct Edge));
+    s->batchSize = 0;
+    s->scratch = (struct Edge*)malloc(batchCapacity * sizeof(struct Edge));
+    s->uf = createUnionFind(V);
+    s->edgesSeen = 0;
+    return s;
+}
+
+void freeStreamingMST(struct StreamingMST* s) {
+    free(s->forest);
+    free(s->merged);
+    free(s->batch);
+    free(s->scratch);
+    freeUnionFind(s->uf);
+    free(s);
+}
+
+// Function to merge the pending batch into the forest
+void streamFlush(struct StreamingMST* s) {
+    if (s->batchSize == 0)
+        return;
+    radixSortEdges(s->batch, s->batchSize, s->scratch, s->numThreads);
+    
+    // Start from V singletons again: only forest and batch edges count
+    ufReset(s->uf);
     
-    // Print the MST
-    printf("Edges in the Minimum Spanning Tree:\n");
-    printf("Edge \t\tWeight\n");
-    int totalWeight = 0;
-    for (i = 0; i < e; i++) {
-        printf("%d - %d \t\t%d\n", result[i].src, result[i].dest, result[i].weight);
+    // Kruskal on the merge of the two sorted lists; on equal weights the
+    // forest edge goes first, so an unchanged forest is kept as it is
+    int i = 0, j = 0, e = 0;
+    while (e < s->V - 1 && (i < s->forestSize || j < s->batchSize)) {
+        struct Edge next_edge;
+        if (j == s->batchSize || (i < s->forestSize && s->forest[i].weight <= s->batch[j].weight))
+            next_edge = s->forest[i++];
+        else
+            next_edge = s->batch[j++];
+        if (ufUnion(s->uf, next_edge.src, next_edge.dest))
+            s->merged[e++] = next_edge;
+    }
+    
+    struct Edge* tmp = s->forest;
+    s->forest = s->merged;
+    s->merged = tmp;
+    s->forestSize = e;
+    s->batchSize = 0;
+}
+
+// Function to add one edge to the stream; merges when the batch is full
+void streamAddEdge(struct StreamingMST* s, int src, int dest, int weight) {
+    if (s->batchSize == s->batchCapacity)
+        streamFlush(s);
+    struct Edge* edge = &s->batch[s->batchSize++];
+    edge->src = src;
+    edge->dest = dest;
+    edge->weight = weight;
+    s->edgesSeen++;
+}
+
+// Function to compute a minimum spanning forest by streaming the edges of
+// graph in batches; returns the number of edges in result[]
+int streamingForest(const struct Graph* graph, struct Edge result[], int batchCapacity, int numThreads) {
+    struct StreamingMST* s = createStreamingMST(graph->V, batchCapacity, numThreads);
+    for (int i = 0; i < graph->E; i++)
+        streamAddEdge(s, graph->edge[i].src, graph->edge[i].dest, graph->edge[i].weight);
+    streamFlush(s);
+    int e = s->forestSize;
+    memcpy(result, s->forest, e * sizeof(struct Edge));
+    freeStreamingMST(s);
+    return e;
+}
+
+// Function to compute a minimum spanning forest of graph into result[]
+// The edges of graph are reordered; returns the number of edges in result[]
+int spanningForest(struct Graph* graph, struct Edge result[], enum MSTMode mode, int numThreads) {
+    int V = graph->V;
+    
+    // Create V subsets with single elements
+    struct UnionFind* uf = createUnionFind(V);
+    
+    int e;
+    if (mode == QSORT_KRUSKAL) {
+        // Step 1: Sort all the edges in non-decreasing order of their weight
+        qsort(graph->edge, graph->E, sizeof(graph->edge[0]), compareEdges);
+        e = kruskalScan(V, uf, graph->edge, graph->E, result, 0);
+    } else if (mode == BORUVKA_MST) {
+        e = boruvkaForest(graph, result, numThreads);
+    } else if (mode == STREAM_KRUSKAL) {
+        e = streamingForest(graph, result, STREAM_BATCH_EDGES, numThreads);
+    } else if (mode == KEY_KRUSKAL) {
+        struct CompactEdges* compact = createCompactEdges(graph);
+        e = keyKruskal(V, compact, result);
+        freeCompactEdges(compact);
+    } else {
+        struct Edge* scratch = (struct Edge*)malloc(graph->E * sizeof(struct Edge));
+        if (mode == RADIX_KRUSKAL) {
+            radixSortEdges(graph->edge, graph->E, scratch, numThreads);
+            e = kruskalScan(V, uf, graph->edge, graph->E, result, 0);
+        } else {
+            e = filterKruskal(V, uf, graph->edge, graph->E, scratch, result, 0, numThreads);
+        }
+        free(scratch);
+    }
+    
+    freeUnionFind(uf);
+    return e;
+}
+
+// Function to print a spanning forest (only the total for large graphs)
+void printForest(int V, const struct Edge result[], int e) {
+    long long totalWeight = 0;
+    for (int i = 0; i < e; i++)
         totalWeight += result[i].weight;
+    if (V <= 20) {
+        printf("Edges in the Minimum Spanning Tree:\n");
+        printf("Edge \t\tWeight\n");
+        for (int i = 0; i < e; i++)
+            printf("%d - %d \t\t%d\n", result[i].src, result[i].dest, result[i].weight);
+    } else {
+        printf("Minimum spanning forest with %d edges\n", e);
+    }
+    printf("\nTotal weight of MST: %lld\n", totalWeight);
+}
+
+// Function to construct MST using Kruskal's algorithm
+void KruskalMST(struct Graph* graph, enum MSTMode mode, int numThreads) {
+    int V = graph->V;
+    struct Edge* result = (struct Edge*)malloc(V * sizeof(struct Edge));  // This will store the resultant MST
+    int e = spanningForest(graph, result, mode, numThreads);
+    printForest(V, result, e);
+    free(result);
+}
+
+// Name of a Kruskal mode, for printing
+const char* modeName(enum MSTMode mode) {
+    return mode == RADIX_KRUSKAL ? "radix" : mode == FILTER_KRUSKAL ? "filter"
+        : mode == BORUVKA_MST ? "boruvka" : mode == STREAM_KRUSKAL ? "stream"
+        : mode == KEY_KRUSKAL ? "keys" : "qsort";
+}
+
+// Parse a mode name; returns false if the name is unknown
+bool parseMode(const char* name, enum MSTMode* mode) {
+    for (int m = QSORT_KRUSKAL; m < NUM_MODES; m++) {
+        if (strcmp(name, modeName((enum MSTMode)m)) == 0) {
+            *mode = (enum MSTMode)m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Number of CPUs available to run threads on
+int numCPUs() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+// Simple xorshift random number generator (deterministic for a given seed)
+uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Function to create a random connected graph: a ring through all vertices
+// plus random extra edges, weights in 1..maxWeight
+struct Graph* createRandomGraph(int V, int E, int maxWeight, uint32_t seed) {
+    struct Graph* graph = createGraph(V, E);
+    uint32_t state = seed;
+    for (int i = 0; i < E; i++) {
+        if (i < V) {
+            graph->edge[i].src = i;
+            graph->edge[i].dest = (i + 1) % V;
+        } else {
+            graph->edge[i].src = xorshift32(&state) % V;
+            graph->edge[i].dest = xorshift32(&state) % V;
+        }
+        graph->edge[i].weight = 1 + xorshift32(&state) % maxWeight;
     }
-    printf("\nTotal weight of MST: %d\n", totalWeight);
+    return graph;
+}
+
+// Wall-clock time in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Function to run every mode on copies of one graph; returns the total
+// weight of each in weights[] (time in seconds in times[] if not NULL)
+void runAllModes(struct Graph* graph, int numThreads, long long weights[NUM_MODES], double times[NUM_MODES]) {
+    struct Graph copy = { graph->V, graph->E, (struct Edge*)malloc(graph->E * sizeof(struct Edge)) };
+    struct Edge* result = (struct Edge*)malloc(graph->V * sizeof(struct Edge));
+    for (int m = QSORT_KRUSKAL; m < NUM_MODES; m++) {
+        memcpy(copy.edge, graph->edge, graph->E * sizeof(struct Edge));
+        double start = nowSeconds();
+        int e = spanningForest(&copy, result, (enum MSTMode)m, numThreads);
+        if (times != NULL)
+            times[m] = nowSeconds() - start;
+        weights[m] = 0;
+        for (int i = 0; i < e; i++)
+            weights[m] += result[i].weight;
+    }
+    free(copy.edge);
+    free(result);
+}
+
+// Function to compare all modes on a random graph
+void benchmark(int V, int E, int maxWeight, int numThreads) {
+    struct Graph* graph = createRandomGraph(V, E, maxWeight, 1);
+    long long weights[NUM_MODES];
+    double times[NUM_MODES];
+    printf("Random graph: %d vertices, %d edges, weights 1..%d, %d threads\n\n", V, E, maxWeight, numThreads);
+    runAllModes(graph, numThreads, weights, times);
+    printf("Mode        Time       MST weight\n");
+    for (int m = QSORT_KRUSKAL; m < NUM_MODES; m++)
+        printf("%-7s %8.3f s   %lld %s\n", modeName((enum MSTMode)m), times[m], weights[m],
+               weights[m] == weights[QSORT_KRUSKAL] ? "" : "WEIGHTS DIFFER");
+    free(graph->edge);
+    free(graph);
+}
+
+// Function to build the edge list of a graph file
+// Returns NULL (after printing why) if the file cannot be read
+struct Graph* loadGraphFile(const char* path) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return NULL;
     
-    free(subsets);
+    // Count the edges first: an undirected file keeps only u < v
+    int numEdges = 0;
+    for (int u = 0; u < file->numVertices; u++)
+        for (int e = file->rowStart[u]; e < file->rowStart[u + 1]; e++)
+            if (file->directed || u < file->adj[e])
+                numEdges++;
+    
+    struct Graph* graph = createGraph(file->numVertices, numEdges);
+    int i = 0;
+    for (int u = 0; u < file->numVertices; u++) {
+        for (int e = file->rowStart[u]; e < file->rowStart[u + 1]; e++) {
+            if (file->directed || u < file->adj[e]) {
+                graph->edge[i].src = u;
+                graph->edge[i].dest = file->adj[e];
+                graph->edge[i].weight = file->weight[e];
+                i++;
+            }
+        }
+    }
+    closeGraphFile(file);
+    return graph;
+}
+
+// Function to compute an MST of "u v w" lines read from in, B edges at a
+// time; returns false (after printing why) on a malformed line
+bool streamTextEdges(FILE* in, int V, int batchCapacity, int numThreads) {
+    struct StreamingMST* s = createStreamingMST(V, batchCapacity, numThreads);
+    int u, v, w, fields;
+    while ((fields = fscanf(in, "%d %d %d", &u, &v, &w)) == 3) {
+        if (u < 0 || u >= V || v < 0 || v >= V || w < 0) {
+            printf("Bad edge %d %d %d after %lld edges (need 0 <= u, v < %d and w >= 0)\n",
+                   u, v, w, s->edgesSeen, V);
+            freeStreamingMST(s);
+            return false;
+        }
+        streamAddEdge(s, u, v, w);
+    }
+    if (fields != EOF) {
+        printf("Malformed input after %lld edges\n", s->edgesSeen);
+        freeStreamingMST(s);
+        return false;
+    }
+    streamFlush(s);
+    printf("Read %lld edges in batches of %d\n\n", s->edgesSeen, batchCapacity);
+    printForest(V, s->forest, s->forestSize);
+    freeStreamingMST(s);
+    return true;
 }
 
 // Driver program to test above functions
-int main() {
+// Usage: ./3_kruskal [qsort|radix|filter|boruvka|stream|keys]
+//        ./3_kruskal graphFile [qsort|radix|filter|boruvka|stream|keys]
+//        ./3_kruskal bench [V] [E] [maxWeight] [threads]
+//        ./3_kruskal stream-text V [batchSize] [edgeFile]   ("u v w" lines, stdin by default)
+int main(int argc, char* argv[]) {
+    if (argc > 2 && strcmp(argv[1], "stream-text") == 0) {
+        int V = atoi(argv[2]);
+        int batch = argc > 3 ? atoi(argv[3]) : STREAM_BATCH_EDGES;
+        if (V < 1 || batch < 1) {
+            printf("Streaming needs V >= 1 and batchSize >= 1\n");
+            return 1;
+        }
+        FILE* in = stdin;
+        if (argc > 4 && (in = fopen(argv[4], "r")) == NULL) {
+            perror(argv[4]);
+            return 1;
+        }
+        printf("Kruskal's Minimum Spanning Tree Algorithm (streaming)\n");
+        printf("=====================================================\n\n");
+        bool ok = streamTextEdges(in, V, batch, numCPUs());
+        if (in != stdin)
+            fclose(in);
+        return ok ? 0 : 1;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int V = argc > 2 ? atoi(argv[2]) : 1000000;
+        int E = argc > 3 ? atoi(argv[3]) : 10000000;
+        int maxWeight = argc > 4 ? atoi(argv[4]) : 1000000;
+        int threads = argc > 5 ? atoi(argv[5]) : numCPUs();
+        if (V < 1 || E < V || maxWeight < 1 || threads < 1) {
+            printf("Benchmark needs V >= 1, E >= V and maxWeight, threads >= 1\n");
+            return 1;
+        }
+        benchmark(V, E, maxWeight, threads);
+        return 0;
+    }
+    
+    enum MSTMode mode = QSORT_KRUSKAL;
+    int arg = 1;
+    if (argc > arg && parseMode(argv[arg], &mode))
+        arg++;
+    
+    if (argc > arg) {
+        struct Graph* graph = loadGraphFile(argv[arg]);
+        if (graph == NULL)
+            return 1;
+        if (argc > arg + 1 && !parseMode(argv[arg + 1], &mode)) {
+            printf("Unknown mode %s (qsort, radix, filter, boruvka, stream or keys)\n", argv[arg + 1]);
+            return 1;
+        }
+        printf("Kruskal's Minimum Spanning Tree Algorithm\n");
+        printf("==========================================\n\n");
+        printf("Loaded %s: %d vertices, %d edges\n", argv[arg], graph->V, graph->E);
+        printf("Mode: %s\n\n", modeName(mode));
+        double start = nowSeconds();
+        KruskalMST(graph, mode, numCPUs());
+        printf("(%.3f s)\n", nowSeconds() - start);
+        free(graph->edge);
+        free(graph);
+        return 0;
+    }
+    
     /* Example graph:
          10
       0--------1
@@ -163,10 +947,39 @@ int main() {
     printf("Kruskal's Minimum Spanning Tree Algorithm\n");
     printf("==========================================\n\n");
     
-    KruskalMST(graph);
+    printf("Mode: %s\n\n", modeName(mode));
+    KruskalMST(graph, mode, numCPUs());
     
     free(graph->edge);
     free(graph);
     
+    // Cross-check the radix, Filter-Kruskal, Borůvka, streaming and key-only
+    // modes against qsort; the small weight range gives many equal weights and
+    // the third graph has about half of its weights negative. The stream is
+    // also run with small batches, so many merges take place
+    long long weights[NUM_MODES];
+    struct Edge* streamed = (struct Edge*)malloc(60000 * sizeof(struct Edge));
+    bool ok = true;
+    for (int seed = 1; seed <= 3 && ok; seed++) {
+        struct Graph* random = createRandomGraph(20000 * seed, 150000 * seed, seed == 2 ? 5 : 100000, seed);
+        if (seed == 3)
+            for (int i = 0; i < random->E; i++)
+                random->edge[i].weight -= 50000;
+        runAllModes(random, 4, weights, NULL);
+        ok = weights[RADIX_KRUSKAL] == weights[QSORT_KRUSKAL] && weights[FILTER_KRUSKAL] == weights[QSORT_KRUSKAL]
+            && weights[BORUVKA_MST] == weights[QSORT_KRUSKAL] && weights[STREAM_KRUSKAL] == weights[QSORT_KRUSKAL]
+            && weights[KEY_KRUSKAL] == weights[QSORT_KRUSKAL];
+        int e = streamingForest(random, streamed, 7000 * seed, 4);
+        long long streamedWeight = 0;
+        for (int i = 0; i < e; i++)
+            streamedWeight += streamed[i].weight;
+        ok = ok && streamedWeight == weights[QSORT_KRUSKAL];
+        free(random->edge);
+        free(random);
+    }
+    free(streamed);
+    printf("\nChecking radix, Filter-Kruskal, Borůvka, streaming and key-only against qsort (also with negative weights): %s\n",
+           ok ? "PASSED" : "FAILED");
+    
     return 0;
 }
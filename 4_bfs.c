@@ -11,30 +11,150 @@
  *       - Mark it as visited
  *       - Enqueue it to Q
  * 4. Repeat until the queue is empty
+ *
+ * With an adjacency matrix every dequeued vertex scans a full row, so BFS
+ * takes O(V^2). bfsCSR() runs on a graph in Compressed Sparse Row (CSR)
+ * form instead, where the neighbours of u are adj[rowStart[u] ..
+ * rowStart[u+1]-1], and expands one level (frontier) at a time in one of two
+ * directions (Beamer's direction-optimizing BFS):
+ * - Top-down: every frontier vertex visits its neighbours and claims the
+ *   unvisited ones. Cheap while the frontier is small
+ * - Bottom-up: every unvisited vertex looks through its neighbours for one
+ *   in the frontier and stops at the first. When the frontier holds a large
+ *   part of the graph, most unvisited vertices find a parent after a few
+ *   edges, so far fewer edges are examined than top-down
+ * The search starts top-down and switches to bottom-up when the edges out
+ * of the frontier (mf) exceed the edges of unvisited vertices (mu) / ALPHA,
+ * and back to top-down once the frontier has shrunk below V / BETA.
+ * Bottom-up needs the edges into a vertex, which an undirected CSR graph
+ * stores in the vertex's own row; directed graphs always run top-down.
+ * Both return a parent and a depth for every vertex.
+ * Time Complexity: O(V + E), and on power-law graphs usually far fewer edge
+ * checks than E
+ *
+ * bfsParallel() runs the same level-by-level search on several threads.
+ * The frontier, the next frontier and the visited set are bitmaps with one
+ * bit per vertex. Threads take chunks of bitmap words from a shared cursor:
+ * - Top-down: for every frontier bit, claim each neighbour with an atomic
+ *   test-and-set (fetch-or) on its visited bit; only the winning thread
+ *   writes its parent and depth and sets its bit in the next frontier
+ * - Bottom-up: each thread owns the vertices of its chunks, so it can mark
+ *   them visited without contention
+ * A barrier ends every level, and the direction is chosen as above.
+ * Throughput is reported in traversed edges per second (TEPS): the edges
+ * of the reached component divided by the search time.
+ *
+ * multiSourceBFS() (MS-BFS) runs up to 64 searches at once. Bit i of a
+ * vertex's 64-bit words belongs to the search from sources[i]:
+ * - seen[v]: searches that have reached v
+ * - visit[v]: searches with v in their current frontier
+ * Every level scans the adjacency of each vertex with visit[v] != 0 once and
+ * ORs visit[v] into visitNext[] of all neighbours, advancing every search
+ * that has v in its frontier with one pass over the edges. The new bits
+ * visitNext[v] & ~seen[v] are then the searches that reach v at this level.
+ * Many sources share their frontiers on small-world graphs, so 64 searches
+ * cost far less than 64 separate BFS runs.
+ *
+ * connectedComponents() labels the components of an undirected graph on
+ * several threads with Afforest (Sutton, Ben-Nun and Barak). All threads
+ * link vertices in the lock-free union-find of union_find.h:
+ * 1. Link every vertex to its first AFFOREST_SAMPLE_EDGES neighbours; this
+ *    usually joins most of the graph into one giant component
+ * 2. Find the most frequent root among AFFOREST_SAMPLE_VERTICES random
+ *    vertices: the (probable) giant component
+ * 3. Link the remaining edges, skipping every vertex already in the giant
+ *    component. An edge between such a vertex and an outside vertex is still
+ *    seen from the outside vertex, since the graph is undirected
+ * 4. The root of every vertex is its label
+ * Most edges are never touched, so this beats a sequential BFS from every
+ * unvisited vertex (componentsBFS(), kept to verify the labels).
+ *
+ * The adjacency matrix holds one bit per vertex pair in a single
+ * cache-aligned allocation (32 times smaller than one int per entry). BFS()
+ * keeps its visited set in the same layout, so the unvisited neighbours of
+ * u are row[u] & ~visited, 64 columns per word, and each is found with a
+ * count-trailing-zeros instruction instead of testing every column.
+ *
+ * benchmarkReorder() renumbers the vertices of an R-MAT graph with the
+ * orders of graph_reorder.h (degree, RCM, community) and times the same
+ * searches on every numbering. Depths are mapped back through the
+ * permutation (depth[v] = relabelled depth[newId[v]]) and checked against
+ * the search on the input numbering.
+ *
+ * The graph can also be read from a graph file (see graph_file.h). The
+ * matrix version copies its edges into the adjacency matrix, so files are
+ * limited to MAX_FILE_VERTICES vertices; the CSR version uses the arrays of
+ * the mapped file in place.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "graph_file.h"
+#include "union_find.h"
+#include "graph_reorder.h"
 
-#define MAX 100
+#define MAX_FILE_VERTICES 32768 // Largest graph file loaded into a matrix (128 MB of bits)
+#define MATRIX_ROW_ALIGN_WORDS 8 // Matrix rows start on 64-byte cache lines
+#define ALPHA 15                // Go bottom-up when mf > mu / ALPHA
+#define BETA 18                 // Go back top-down when the frontier < V / BETA
+#define BITMAP_CHUNK_WORDS 16   // Bitmap words (64 vertices each) a thread takes at once
+#define MSBFS_LANES 64          // Searches run together by multiSourceBFS()
+#define AFFOREST_SAMPLE_EDGES 2       // Neighbours linked per vertex before sampling
+#define AFFOREST_SAMPLE_VERTICES 1024 // Vertices sampled to find the giant component
+#define CC_CHUNK_VERTICES 4096        // Vertices a thread takes at once
 
 // Structure to represent a queue
 struct Queue {
-    int items[MAX];
+    int* items;
+    int capacity;
     int front;
     int rear;
 };
 
-// Structure to represent a graph
+// Structure to represent a graph as a bit-packed adjacency matrix
+// Bit v of row u is set if u - v is an edge. All rows share one allocation
+// and each starts on a cache line
 struct Graph {
     int numVertices;
-    int** adjMatrix;
+    int rowWords;       // 64-bit words per row, a multiple of MATRIX_ROW_ALIGN_WORDS
+    uint64_t* adjBits;  // Row u is adjBits[u * rowWords .. (u+1) * rowWords - 1]
 };
 
-// Function to create a queue
-struct Queue* createQueue() {
+// Structure to represent an unweighted graph in CSR form
+struct CSRGraph {
+    int numVertices;
+    int numEdges;   // Stored edges (twice the number of undirected edges)
+    int* rowStart;  // rowStart[u] .. rowStart[u+1]-1 index the neighbours of u
+    int* adj;
+    bool directed;  // Rows hold only outgoing edges (no bottom-up steps)
+};
+
+// How bfsCSR() expands the frontier
+enum BFSMode {
+    TOP_DOWN,             // Always top-down (queue-based BFS)
+    DIRECTION_OPTIMIZING  // Switch between top-down and bottom-up
+};
+
+// What a CSR search did, for the benchmark
+struct BFSStats {
+    int reached;            // Vertices with a depth
+    int levels;             // Number of frontiers expanded
+    int bottomUpLevels;     // Of those, expanded bottom-up
+    long long edgesChecked; // Neighbour entries read
+};
+
+// Function to create a queue that can hold capacity items
+struct Queue* createQueue(int capacity) {
     struct Queue* q = (struct Queue*)malloc(sizeof(struct Queue));
+    q->items = (int*)malloc(capacity * sizeof(int));
+    q->capacity = capacity;
     q->front = -1;
     q->rear = -1;
     return q;
@@ -47,7 +167,7 @@ bool isEmpty(struct Queue* q) {
 
 // Add an element to the queue
 void enqueue(struct Queue* q, int value) {
-    if (q->rear == MAX - 1)
+    if (q->rear == q->capacity - 1)
         printf("\nQueue is Full!!");
     else {
         if (q->front == -1)
@@ -78,34 +198,629 @@ struct Graph* createGraph(int vertices) {
     struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
     graph->numVertices = vertices;
     
-    // Allocate memory for adjacency matrix
-    graph->adjMatrix = (int**)malloc(vertices * sizeof(int*));
-    for (int i = 0; i < vertices; i++) {
-        graph->adjMatrix[i] = (int*)malloc(vertices * sizeof(int));
-        for (int j = 0; j < vertices; j++)
-            graph->adjMatrix[i][j] = 0;
-    }
+    // One bit per matrix entry, rows padded to whole cache lines
+    int words = (vertices + 63) / 64;
+    graph->rowWords = (words + MATRIX_ROW_ALIGN_WORDS - 1) / MATRIX_ROW_ALIGN_WORDS * MATRIX_ROW_ALIGN_WORDS;
+    size_t bytes = (size_t)vertices * graph->rowWords * sizeof(uint64_t);
+    graph->adjBits = (uint64_t*)aligned_alloc(64, bytes > 0 ? bytes : 64);
+    memset(graph->adjBits, 0, bytes);
     
     return graph;
 }
 
+// Function to free a graph
+void freeGraph(struct Graph* graph) {
+    free(graph->adjBits);
+    free(graph);
+}
+
+// Row of u in the adjacency matrix
+static inline uint64_t* matrixRow(const struct Graph* graph, int u) {
+    return graph->adjBits + (size_t)u * graph->rowWords;
+}
+
 // Function to add an edge to the graph
 void addEdge(struct Graph* graph, int src, int dest) {
-    graph->adjMatrix[src][dest] = 1;
-    graph->adjMatrix[dest][src] = 1;  // For undirected graph
+    matrixRow(graph, src)[dest >> 6] |= 1ull << (dest & 63);
+    matrixRow(graph, dest)[src >> 6] |= 1ull << (src & 63);  // For undirected graph
+}
+
+// Function to load a graph file into an adjacency matrix graph
+// Returns NULL (after printing why) if the file cannot be used
+struct Graph* loadGraphFile(const char* path) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return NULL;
+    if (file->numVertices < 1 || file->numVertices > MAX_FILE_VERTICES) {
+        printf("Graph has %d vertices, the matrix version handles 1 to %d\n",
+               file->numVertices, MAX_FILE_VERTICES);
+        closeGraphFile(file);
+        return NULL;
+    }
+    
+    struct Graph* graph = createGraph(file->numVertices);
+    for (int u = 0; u < file->numVertices; u++)
+        for (int e = file->rowStart[u]; e < file->rowStart[u + 1]; e++)
+            addEdge(graph, u, file->adj[e]);
+    closeGraphFile(file);
+    return graph;
+}
+
+// State shared by the threads of bfsParallel()
+struct ParallelBFS {
+    const struct CSRGraph* graph;
+    int* parent;
+    int* depth;
+    int numWords;                  // Words in each bitmap
+    _Atomic uint64_t* visited;     // Bit v set once v has a depth
+    _Atomic uint64_t* frontier;    // Vertices of the current level
+    _Atomic uint64_t* next;        // Vertices of the next level
+    atomic_int cursor;             // Next bitmap word to hand out
+    atomic_int nextSize;           // Vertices added to next[] in this level
+    atomic_llong nextEdges;        // Their degrees summed (mf of the next level)
+    atomic_llong edgesChecked;
+    int level;
+    int frontierSize, prevFrontierSize;
+    long long mf, mu;
+    bool bottomUp;
+    bool done;
+    struct BFSStats stats;
+    pthread_barrier_t barrier;
+};
+
+// State shared by the threads of connectedComponents()
+struct Afforest {
+    const struct CSRGraph* graph;
+    struct ConcurrentUnionFind* uf;
+    int* label;
+    int phase;             // 1: sample edges, 3: remaining edges, 4: labels
+    int giant;             // Root skipped in phase 3 (-1: none)
+    atomic_int cursor;     // Next vertex to hand out
+};
+
+// Function to build an undirected CSR graph from an edge list (src[i] - dest[i])
+// Edges are bucketed by endpoint with a counting sort, so this runs in O(V + E)
+struct CSRGraph* createCSRGraph(int numVertices, int numEdges, const int src[], const int dest[]) {
+    struct CSRGraph* graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    graph->numVertices = numVertices;
+    graph->numEdges = 2 * numEdges;
+    graph->rowStart = (int*)calloc(numVertices + 1, sizeof(int));
+    graph->adj = (int*)malloc(2 * (size_t)numEdges * sizeof(int));
+    graph->directed = false;
+    
+    // Count the degree of every vertex
+    for (int i = 0; i < numEdges; i++) {
+        graph->rowStart[src[i] + 1]++;
+        graph->rowStart[dest[i] + 1]++;
+    }
+    
+    // Prefix sum turns degrees into row offsets
+    for (int u = 0; u < numVertices; u++)
+        graph->rowStart[u + 1] += graph->rowStart[u];
+    
+    // Scatter both directions of every edge into their rows
+    int* next = (int*)malloc(numVertices * sizeof(int));
+    memcpy(next, graph->rowStart, numVertices * sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        graph->adj[next[src[i]]++] = dest[i];
+        graph->adj[next[dest[i]]++] = src[i];
+    }
+    free(next);
+    
+    return graph;
+}
+
+// Function to free a CSR graph
+void freeCSRGraph(struct CSRGraph* graph) {
+    free(graph->rowStart);
+    free(graph->adj);
+    free(graph);
+}
+
+// One top-down level: claim the unvisited neighbours of frontier[]
+// New vertices are appended to next[]; returns how many
+int topDownStep(const struct CSRGraph* graph, const int frontier[], int frontierSize,
+                int next[], int parent[], int depth[], int level, struct BFSStats* stats) {
+    int nextSize = 0;
+    for (int i = 0; i < frontierSize; i++) {
+        int u = frontier[i];
+        for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+            int v = graph->adj[e];
+            if (depth[v] == -1) {
+                depth[v] = level + 1;
+                parent[v] = u;
+                next[nextSize++] = v;
+            }
+        }
+        stats->edgesChecked += graph->rowStart[u + 1] - graph->rowStart[u];
+    }
+    return nextSize;
+}
+
+// One bottom-up level: every unvisited vertex takes the first neighbour
+// marked in inFrontier[] as its parent. New vertices are appended to
+// next[]; returns how many
+int bottomUpStep(const struct CSRGraph* graph, const bool inFrontier[],
+                 int next[], int parent[], int depth[], int level, struct BFSStats* stats) {
+    int nextSize = 0;
+    for (int v = 0; v < graph->numVertices; v++) {
+        if (depth[v] != -1)
+            continue;
+        for (int e = graph->rowStart[v]; e < graph->rowStart[v + 1]; e++) {
+            stats->edgesChecked++;
+            int u = graph->adj[e];
+            if (inFrontier[u]) {
+                depth[v] = level + 1;
+                parent[v] = u;
+                next[nextSize++] = v;
+                break;
+            }
+        }
+    }
+    return nextSize;
+}
+
+// Function to run BFS on a CSR graph from source
+// Fills parent[] (parent[source] = source, -1 if unreached) and depth[]
+// (-1 if unreached); stats may be NULL. Returns the number of reached vertices
+int bfsCSR(const struct CSRGraph* graph, int source, int parent[], int depth[],
+           enum BFSMode mode, struct BFSStats* stats) {
+    int V = graph->numVertices;
+    struct BFSStats local = { 0, 0, 0, 0 };
+    int* frontier = (int*)malloc(V * sizeof(int));
+    int* next = (int*)malloc(V * sizeof(int));
+    bool* inFrontier = NULL;  // Only needed for bottom-up steps
+    for (int v = 0; v < V; v++) {
+        parent[v] = -1;
+        depth[v] = -1;
+    }
+    parent[source] = source;
+    depth[source] = 0;
+    frontier[0] = source;
+    int frontierSize = 1;
+    local.reached = 1;
+    
+    // mf: edges out of the frontier, mu: edges of unvisited vertices
+    long long mf = graph->rowStart[source + 1] - graph->rowStart[source];
+    long long mu = graph->numEdges - mf;
+    bool bottomUp = false;
+    int prevFrontierSize = 0;
+    
+    for (int level = 0; frontierSize > 0; level++) {
+        // Switch only while the frontier grows (to bottom-up) or shrinks
+        // (back to top-down), so the search does not flip every level
+        if (mode == DIRECTION_OPTIMIZING && !graph->directed) {
+            if (!bottomUp && mf > mu / ALPHA && frontierSize > prevFrontierSize)
+                bottomUp = true;
+            else if (bottomUp && frontierSize < V / BETA && frontierSize < prevFrontierSize)
+                bottomUp = false;
+        }
+        prevFrontierSize = frontierSize;
+        
+        int nextSize;
+        if (bottomUp) {
+            if (inFrontier == NULL)
+                inFrontier = (bool*)calloc(V, sizeof(bool));
+            for (int i = 0; i < frontierSize; i++)
+                inFrontier[frontier[i]] = true;
+            nextSize = bottomUpStep(graph, inFrontier, next, parent, depth, level, &local);
+            for (int i = 0; i < frontierSize; i++)
+                inFrontier[frontier[i]] = false;
+            local.bottomUpLevels++;
+        } else {
+            nextSize = topDownStep(graph, frontier, frontierSize, next, parent, depth, level, &local);
+        }
+        local.levels++;
+        local.reached += nextSize;
+        
+        // Degrees of the new frontier move from mu to mf
+        mf = 0;
+        for (int i = 0; i < nextSize; i++)
+            mf += graph->rowStart[next[i] + 1] - graph->rowStart[next[i]];
+        mu -= mf;
+        
+        int* tmp = frontier;
+        frontier = next;
+        next = tmp;
+        frontierSize = nextSize;
+    }
+    
+    free(frontier);
+    free(next);
+    free(inFrontier);
+    if (stats != NULL)
+        *stats = local;
+    return local.reached;
+}
+
+// Top-down share of one level: claim the neighbours of the frontier
+// vertices in one chunk of bitmap words
+void parallelTopDownChunk(struct ParallelBFS* b, int firstWord, int lastWord,
+                          int* added, long long* addedEdges, long long* checked) {
+    const struct CSRGraph* graph = b->graph;
+    for (int w = firstWord; w < lastWord; w++) {
+        uint64_t bits = atomic_load_explicit(&b->frontier[w], memory_order_relaxed);
+        while (bits != 0) {
+            int u = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+                int v = graph->adj[e];
+                uint64_t bit = 1ull << (v & 63);
+                // Plain load first: most neighbours are visited already
+                if (atomic_load_explicit(&b->visited[v >> 6], memory_order_relaxed) & bit)
+                    continue;
+                if (atomic_fetch_or_explicit(&b->visited[v >> 6], bit, memory_order_relaxed) & bit)
+                    continue;  // Another thread claimed v first
+                b->parent[v] = u;
+                b->depth[v] = b->level + 1;
+                atomic_fetch_or_explicit(&b->next[v >> 6], bit, memory_order_relaxed);
+                (*added)++;
+                *addedEdges += graph->rowStart[v + 1] - graph->rowStart[v];
+            }
+            *checked += graph->rowStart[u + 1] - graph->rowStart[u];
+        }
+    }
+}
+
+// Bottom-up share of one level: the unvisited vertices of one chunk of
+// bitmap words look for a parent in the frontier
+void parallelBottomUpChunk(struct ParallelBFS* b, int firstWord, int lastWord,
+                           int* added, long long* addedEdges, long long* checked) {
+    const struct CSRGraph* graph = b->graph;
+    for (int w = firstWord; w < lastWord; w++) {
+        uint64_t unvisited = ~atomic_load_explicit(&b->visited[w], memory_order_relaxed);
+        if (w == b->numWords - 1 && graph->numVertices % 64 != 0)
+            unvisited &= (1ull << (graph->numVertices % 64)) - 1;  // Past the last vertex
+        uint64_t found = 0;
+        while (unvisited != 0) {
+            int v = w * 64 + __builtin_ctzll(unvisited);
+            unvisited &= unvisited - 1;
+            for (int e = graph->rowStart[v]; e < graph->rowStart[v + 1]; e++) {
+                (*checked)++;
+                int u = graph->adj[e];
+                if (atomic_load_explicit(&b->frontier[u >> 6], memory_order_relaxed) & (1ull << (u & 63))) {
+                    b->parent[v] = u;
+                    b->depth[v] = b->level + 1;
+                    found |= 1ull << (v & 63);
+                    (*added)++;
+                    *addedEdges += graph->rowStart[v + 1] - graph->rowStart[v];
+                    break;
+                }
+            }
+        }
+        // This thread owns word w in this level, so no other thread writes it
+        if (found != 0) {
+            atomic_fetch_or_explicit(&b->visited[w], found, memory_order_relaxed);
+            atomic_store_explicit(&b->next[w], found, memory_order_relaxed);
+        }
+    }
+}
+
+// One thread of bfsParallel(); barriers separate the levels
+void* parallelBFSWorker(void* arg) {
+    struct ParallelBFS* b = (struct ParallelBFS*)arg;
+    while (true) {
+        int added = 0;
+        long long addedEdges = 0, checked = 0;
+        while (true) {
+            int first = atomic_fetch_add(&b->cursor, BITMAP_CHUNK_WORDS);
+            if (first >= b->numWords)
+                break;
+            int last = first + BITMAP_CHUNK_WORDS < b->numWords ? first + BITMAP_CHUNK_WORDS : b->numWords;
+            if (b->bottomUp)
+                parallelBottomUpChunk(b, first, last, &added, &addedEdges, &checked);
+            else
+                parallelTopDownChunk(b, first, last, &added, &addedEdges, &checked);
+        }
+        atomic_fetch_add(&b->nextSize, added);
+        atomic_fetch_add(&b->nextEdges, addedEdges);
+        atomic_fetch_add(&b->edgesChecked, checked);
+        
+        // The last thread to arrive sets up the next level
+        if (pthread_barrier_wait(&b->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+            b->stats.levels++;
+            if (b->bottomUp)
+                b->stats.bottomUpLevels++;
+            b->prevFrontierSize = b->frontierSize;
+            b->frontierSize = atomic_exchange(&b->nextSize, 0);
+            b->stats.reached += b->frontierSize;
+            b->mf = atomic_exchange(&b->nextEdges, 0);
+            b->mu -= b->mf;
+            
+            _Atomic uint64_t* tmp = b->frontier;
+            b->frontier = b->next;
+            b->next = tmp;
+            memset((void*)b->next, 0, b->numWords * sizeof(uint64_t));
+            
+            if (!b->graph->directed) {
+                if (!b->bottomUp && b->mf > b->mu / ALPHA && b->frontierSize > b->prevFrontierSize)
+                    b->bottomUp = true;
+                else if (b->bottomUp && b->frontierSize < b->graph->numVertices / BETA
+                         && b->frontierSize < b->prevFrontierSize)
+                    b->bottomUp = false;
+            }
+            b->level++;
+            b->done = b->frontierSize == 0;
+            atomic_store(&b->cursor, 0);
+        }
+        pthread_barrier_wait(&b->barrier);
+        if (b->done)
+            return NULL;
+    }
+}
+
+// Function to run BFS on a CSR graph from source with numThreads threads
+// Fills parent[] and depth[] like bfsCSR(); stats may be NULL. Returns the
+// number of reached vertices
+int bfsParallel(const struct CSRGraph* graph, int source, int parent[], int depth[],
+                int numThreads, struct BFSStats* stats) {
+    struct ParallelBFS b;
+    int V = graph->numVertices;
+    b.graph = graph;
+    b.parent = parent;
+    b.depth = depth;
+    b.numWords = (V + 63) / 64;
+    b.visited = (_Atomic uint64_t*)calloc(b.numWords, sizeof(uint64_t));
+    b.frontier = (_Atomic uint64_t*)calloc(b.numWords, sizeof(uint64_t));
+    b.next = (_Atomic uint64_t*)calloc(b.numWords, sizeof(uint64_t));
+    atomic_init(&b.cursor, 0);
+    atomic_init(&b.nextSize, 0);
+    atomic_init(&b.nextEdges, 0);
+    atomic_init(&b.edgesChecked, 0);
+    for (int v = 0; v < V; v++) {
+        parent[v] = -1;
+        depth[v] = -1;
+    }
+    parent[source] = source;
+    depth[source] = 0;
+    atomic_store(&b.visited[source >> 6], 1ull << (source & 63));
+    atomic_store(&b.frontier[source >> 6], 1ull << (source & 63));
+    b.level = 0;
+    b.frontierSize = 1;
+    b.prevFrontierSize = 0;
+    b.mf = graph->rowStart[source + 1] - graph->rowStart[source];
+    b.mu = graph->numEdges - b.mf;
+    b.bottomUp = false;
+    b.done = false;
+    b.stats = (struct BFSStats){ 1, 0, 0, 0 };
+    pthread_barrier_init(&b.barrier, NULL, numThreads);
+    
+    pthread_t* ids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&ids[t], NULL, parallelBFSWorker, &b);
+    parallelBFSWorker(&b);  // The calling thread works too
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(ids[t], NULL);
+    
+    b.stats.edgesChecked = atomic_load(&b.edgesChecked);
+    pthread_barrier_destroy(&b.barrier);
+    free(ids);
+    free((void*)b.visited);
+    free((void*)b.frontier);
+    free((void*)b.next);
+    if (stats != NULL)
+        *stats = b.stats;
+    return b.stats.reached;
+}
+
+// Function to run BFS from up to MSBFS_LANES sources at once
+// Any output may be NULL: dist[i * V + v] is the hop distance from
+// sources[i] to v (-1 if unreached), distanceSum[i] the sum of the
+// distances from sources[i] and reachedCount[i] the vertices it reaches.
+// Returns the number of levels (the largest distance + 1)
+int multiSourceBFS(const struct CSRGraph* graph, const int sources[], int numSources,
+                   int dist[], long long distanceSum[], int reachedCount[]) {
+    int V = graph->numVertices;
+    uint64_t* seen = (uint64_t*)calloc(V, sizeof(uint64_t));
+    uint64_t* visit = (uint64_t*)calloc(V, sizeof(uint64_t));
+    uint64_t* visitNext = (uint64_t*)calloc(V, sizeof(uint64_t));
+    if (dist != NULL)
+        for (long long i = 0; i < (long long)numSources * V; i++)
+            dist[i] = -1;
+    for (int i = 0; i < numSources; i++) {
+        seen[sources[i]] |= 1ull << i;
+        visit[sources[i]] |= 1ull << i;
+        if (dist != NULL)
+            dist[(long long)i * V + sources[i]] = 0;
+        if (distanceSum != NULL)
+            distanceSum[i] = 0;
+        if (reachedCount != NULL)
+            reachedCount[i] = 1;
+    }
+    
+    int level = 0;
+    bool active = numSources > 0;
+    while (active) {
+        level++;
+        
+        // One scan of each frontier vertex's edges advances all its searches
+        for (int v = 0; v < V; v++) {
+            uint64_t searches = visit[v];
+            if (searches == 0)
+                continue;
+            for (int e = graph->rowStart[v]; e < graph->rowStart[v + 1]; e++)
+                visitNext[graph->adj[e]] |= searches;
+        }
+        
+        // Keep only searches that reach v for the first time
+        active = false;
+        for (int v = 0; v < V; v++) {
+            uint64_t reached = visitNext[v] & ~seen[v];
+            visitNext[v] = 0;
+            visit[v] = reached;
+            if (reached == 0)
+                continue;
+            active = true;
+            seen[v] |= reached;
+            while (reached != 0) {
+                int lane = __builtin_ctzll(reached);
+                reached &= reached - 1;
+                if (dist != NULL)
+                    dist[(long long)lane * V + v] = level;
+                if (distanceSum != NULL)
+                    distanceSum[lane] += level;
+                if (reachedCount != NULL)
+                    reachedCount[lane]++;
+            }
+        }
+    }
+    
+    free(seen);
+    free(visit);
+    free(visitNext);
+    return level;
+}
+
+// Simple xorshift random number generator (deterministic for a given seed)
+uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// One thread of a connectedComponents() phase, taking chunks of vertices
+void* afforestWorker(void* arg) {
+    struct Afforest* a = (struct Afforest*)arg;
+    const struct CSRGraph* graph = a->graph;
+    while (true) {
+        int first = atomic_fetch_add(&a->cursor, CC_CHUNK_VERTICES);
+        if (first >= graph->numVertices)
+            return NULL;
+        int last = first + CC_CHUNK_VERTICES < graph->numVertices ? first + CC_CHUNK_VERTICES : graph->numVertices;
+        for (int v = first; v < last; v++) {
+            int begin = graph->rowStart[v], end = graph->rowStart[v + 1];
+            if (a->phase == 1) {
+                if (end > begin + AFFOREST_SAMPLE_EDGES)
+                    end = begin + AFFOREST_SAMPLE_EDGES;
+                for (int e = begin; e < end; e++)
+                    cufUnion(a->uf, v, graph->adj[e]);
+            } else if (a->phase == 3) {
+                if (cufFind(a->uf, v) == a->giant)
+                    continue;
+                for (int e = begin + AFFOREST_SAMPLE_EDGES; e < end; e++)
+                    cufUnion(a->uf, v, graph->adj[e]);
+            } else {
+                a->label[v] = cufFind(a->uf, v);
+            }
+        }
+    }
+}
+
+// Run one phase of connectedComponents() on numThreads threads
+void runAfforestPhase(struct Afforest* a, int phase, int numThreads) {
+    a->phase = phase;
+    atomic_store(&a->cursor, 0);
+    pthread_t* ids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&ids[t], NULL, afforestWorker, a);
+    afforestWorker(a);  // The calling thread takes chunks too
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(ids[t], NULL);
+    free(ids);
+}
+
+// Function to label the connected components of an undirected CSR graph
+// with numThreads threads. Vertices get the same label[] exactly when they
+// are connected (labels are vertex numbers); returns the number of components
+int connectedComponents(const struct CSRGraph* graph, int label[], int numThreads) {
+    struct Afforest a;
+    a.graph = graph;
+    a.uf = createConcurrentUnionFind(graph->numVertices);
+    a.label = label;
+    a.giant = -1;
+    atomic_init(&a.cursor, 0);
+    
+    runAfforestPhase(&a, 1, numThreads);
+    
+    // Phase 2: the most frequent root of a sample (sequential, it is small)
+    // Directed rows would miss edges into skipped vertices, so no skipping
+    if (!graph->directed && graph->numVertices > 0) {
+        int sample[AFFOREST_SAMPLE_VERTICES];
+        uint32_t state = 2463534242u;
+        for (int i = 0; i < AFFOREST_SAMPLE_VERTICES; i++)
+            sample[i] = cufFind(a.uf, xorshift32(&state) % graph->numVertices);
+        int bestCount = 0;
+        for (int i = 0; i < AFFOREST_SAMPLE_VERTICES; i++) {
+            int count = 0;
+            for (int j = i; j < AFFOREST_SAMPLE_VERTICES; j++)
+                count += sample[j] == sample[i];
+            if (count > bestCount) {
+                bestCount = count;
+                a.giant = sample[i];
+            }
+        }
+    }
+    
+    runAfforestPhase(&a, 3, numThreads);
+    runAfforestPhase(&a, 4, numThreads);
+    int numComponents = cufNumSets(a.uf);
+    freeConcurrentUnionFind(a.uf);
+    return numComponents;
+}
+
+// Function to label the connected components with a BFS from every
+// unvisited vertex in turn (the sequential reference); label[v] is the
+// first vertex of v's component. Returns the number of components
+int componentsBFS(const struct CSRGraph* graph, int label[]) {
+    int V = graph->numVertices;
+    int* queue = (int*)malloc(V * sizeof(int));
+    int numComponents = 0;
+    for (int v = 0; v < V; v++)
+        label[v] = -1;
+    for (int s = 0; s < V; s++) {
+        if (label[s] != -1)
+            continue;
+        numComponents++;
+        int head = 0, tail = 0;
+        label[s] = s;
+        queue[tail++] = s;
+        while (head < tail) {
+            int u = queue[head++];
+            for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+                if (label[graph->adj[e]] == -1) {
+                    label[graph->adj[e]] = s;
+                    queue[tail++] = graph->adj[e];
+                }
+            }
+        }
+    }
+    free(queue);
+    return numComponents;
+}
+
+// Function to check that two labelings describe the same partition:
+// mapping the labels of a to those of b must be one-to-one
+bool sameComponents(int V, const int a[], const int b[]) {
+    int* map = (int*)malloc(V * sizeof(int));
+    int* inverse = (int*)malloc(V * sizeof(int));
+    for (int v = 0; v < V; v++)
+        map[v] = inverse[v] = -1;
+    bool ok = true;
+    for (int v = 0; v < V && ok; v++) {
+        if (map[a[v]] == -1 && inverse[b[v]] == -1) {
+            map[a[v]] = b[v];
+            inverse[b[v]] = a[v];
+        }
+        ok = map[a[v]] == b[v] && inverse[b[v]] == a[v];
+    }
+    free(map);
+    free(inverse);
+    return ok;
 }
 
 // BFS traversal algorithm
 void BFS(struct Graph* graph, int startVertex) {
-    struct Queue* q = createQueue();
+    // Every vertex is enqueued at most once
+    struct Queue* q = createQueue(graph->numVertices);
     
-    // Create visited array to keep track of visited vertices
-    bool* visited = (bool*)malloc(graph->numVertices * sizeof(bool));
-    for (int i = 0; i < graph->numVertices; i++)
-        visited[i] = false;
+    // Visited set with one bit per vertex, laid out like a matrix row
+    uint64_t* visited = (uint64_t*)calloc(graph->rowWords, sizeof(uint64_t));
     
     // Mark the starting vertex as visited and enqueue it
-    visited[startVertex] = true;
+    visited[startVertex >> 6] |= 1ull << (startVertex & 63);
     enqueue(q, startVertex);
     
     printf("BFS Traversal starting from vertex %d: ", startVertex);
@@ -116,47 +831,605 @@ void BFS(struct Graph* graph, int startVertex) {
         int currentVertex = dequeue(q);
         printf("%d ", currentVertex);
         
-        // Get all adjacent vertices of the dequeued vertex
-        // If an adjacent vertex has not been visited, mark it visited and enqueue it
-        for (int i = 0; i < graph->numVertices; i++) {
-            if (graph->adjMatrix[currentVertex][i] == 1 && !visited[i]) {
-                visited[i] = true;
-                enqueue(q, i);
+        // Unvisited neighbours are the row bits not set in visited: take
+        // 64 columns per step and enqueue each new bit in increasing order
+        const uint64_t* row = matrixRow(graph, currentVertex);
+        for (int w = 0; w < graph->rowWords; w++) {
+            uint64_t fresh = row[w] & ~visited[w];
+            visited[w] |= fresh;
+            while (fresh != 0) {
+                enqueue(q, w * 64 + __builtin_ctzll(fresh));
+                fresh &= fresh - 1;
             }
         }
     }
     printf("\n");
     
     free(visited);
+    free(q->items);
     free(q);
 }
 
+// Function to fill a power-law edge list with the R-MAT generator used by
+// Graph500: 2^scale vertices, each edge picks one quadrant of the adjacency
+// matrix per bit with probabilities a = 0.57, b = c = 0.19, d = 0.05.
+// Vertex numbers are then scrambled so high degrees are not all at 0
+void createRMATEdges(int scale, int numEdges, uint32_t seed, int src[], int dest[]) {
+    const uint32_t a = 2448131359u, ab = 3264175145u, abc = 4080218931u;  // 0.57, 0.76, 0.95 of 2^32
+    uint32_t mask = (1u << scale) - 1;
+    uint32_t state = seed;
+    for (int i = 0; i < numEdges; i++) {
+        uint32_t u = 0, v = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            uint32_t r = xorshift32(&state);
+            u = u << 1 | (r >= ab);
+            v = v << 1 | ((r >= a && r < ab) || r >= abc);
+        }
+        // Multiplying by an odd number is a permutation modulo 2^scale
+        src[i] = (int)((u * 2654435761u) & mask);
+        dest[i] = (int)((v * 2654435761u) & mask);
+    }
+}
+
+// Function to create an R-MAT graph with 2^scale vertices and
+// edgeFactor * 2^scale undirected edges
+struct CSRGraph* createRMATGraph(int scale, int edgeFactor, uint32_t seed) {
+    int numVertices = 1 << scale;
+    int numEdges = edgeFactor * numVertices;
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    createRMATEdges(scale, numEdges, seed, src, dest);
+    struct CSRGraph* graph = createCSRGraph(numVertices, numEdges, src, dest);
+    free(src);
+    free(dest);
+    return graph;
+}
+
+// Wall-clock time in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Function to check a BFS result: depth[] must equal expected[] and every
+// reached vertex other than the source must have an edge from a parent one
+// level up
+bool checkBFSTree(const struct CSRGraph* graph, int source, const int parent[], const int depth[],
+                  const int expected[]) {
+    for (int v = 0; v < graph->numVertices; v++) {
+        if (depth[v] != expected[v])
+            return false;
+        if (depth[v] <= 0)
+            continue;
+        int p = parent[v];
+        if (p < 0 || p >= graph->numVertices || depth[p] != depth[v] - 1)
+            return false;
+        bool edge = false;
+        for (int e = graph->rowStart[p]; e < graph->rowStart[p + 1] && !edge; e++)
+            edge = graph->adj[e] == v;
+        if (!edge)
+            return false;
+    }
+    return parent[source] == source;
+}
+
+// Function to check direction-optimizing and parallel BFS against
+// top-down BFS on an R-MAT graph from a few sources
+bool checkDirectionOptimizing(int scale, int edgeFactor, uint32_t seed) {
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, seed);
+    int V = graph->numVertices;
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* depth = (int*)malloc(V * sizeof(int));
+    int* expected = (int*)malloc(V * sizeof(int));
+    bool ok = true;
+    uint32_t state = seed;
+    for (int i = 0; i < 4 && ok; i++) {
+        int source = xorshift32(&state) % V;
+        bfsCSR(graph, source, parent, expected, TOP_DOWN, NULL);
+        bfsCSR(graph, source, parent, depth, DIRECTION_OPTIMIZING, NULL);
+        ok = checkBFSTree(graph, source, parent, depth, expected);
+        bfsParallel(graph, source, parent, depth, 4, NULL);
+        ok = ok && checkBFSTree(graph, source, parent, depth, expected);
+    }
+    free(parent);
+    free(depth);
+    free(expected);
+    freeCSRGraph(graph);
+    return ok;
+}
+
+// Function to check MS-BFS against one top-down BFS per source on an R-MAT
+// graph, with more sources than lanes so that several batches run
+bool checkMultiSource(int scale, int edgeFactor, int numSources, uint32_t seed) {
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, seed);
+    int V = graph->numVertices;
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    int* dist = (int*)malloc((size_t)MSBFS_LANES * V * sizeof(int));
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* depth = (int*)malloc(V * sizeof(int));
+    uint32_t state = seed;
+    for (int i = 0; i < numSources; i++)
+        sources[i] = xorshift32(&state) % V;
+    
+    bool ok = true;
+    for (int first = 0; first < numSources && ok; first += MSBFS_LANES) {
+        int batch = numSources - first < MSBFS_LANES ? numSources - first : MSBFS_LANES;
+        multiSourceBFS(graph, sources + first, batch, dist, NULL, NULL);
+        for (int i = 0; i < batch && ok; i++) {
+            bfsCSR(graph, sources[first + i], parent, depth, TOP_DOWN, NULL);
+            ok = memcmp(dist + (size_t)i * V, depth, V * sizeof(int)) == 0;
+        }
+    }
+    free(sources);
+    free(dist);
+    free(parent);
+    free(depth);
+    freeCSRGraph(graph);
+    return ok;
+}
+
+// Function to compare MS-BFS against one direction-optimizing BFS per
+// source, computing the sum of hop distances from every source
+void benchmarkMultiSource(int scale, int edgeFactor, int numSources) {
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, 1);
+    int V = graph->numVertices;
+    printf("R-MAT graph: %d vertices, %d stored edges, %d sources\n\n", V, graph->numEdges, numSources);
+    
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    long long* singleSum = (long long*)malloc(numSources * sizeof(long long));
+    long long* batchSum = (long long*)malloc(numSources * sizeof(long long));
+    int* reached = (int*)malloc(numSources * sizeof(int));
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* depth = (int*)malloc(V * sizeof(int));
+    uint32_t state = 12345;
+    for (int i = 0; i < numSources; i++)
+        sources[i] = xorshift32(&state) % V;
+    
+    double start = nowSeconds();
+    for (int i = 0; i < numSources; i++) {
+        bfsCSR(graph, sources[i], parent, depth, DIRECTION_OPTIMIZING, NULL);
+        singleSum[i] = 0;
+        for (int v = 0; v < V; v++)
+            if (depth[v] > 0)
+                singleSum[i] += depth[v];
+    }
+    double singleTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    for (int first = 0; first < numSources; first += MSBFS_LANES) {
+        int batch = numSources - first < MSBFS_LANES ? numSources - first : MSBFS_LANES;
+        multiSourceBFS(graph, sources + first, batch, NULL, batchSum + first, reached + first);
+    }
+    double batchTime = nowSeconds() - start;
+    
+    bool same = memcmp(singleSum, batchSum, numSources * sizeof(long long)) == 0;
+    printf("Method                       Total time   Time/source\n");
+    printf("One BFS per source (diropt) %9.3f s  %9.3f ms\n", singleTime, singleTime * 1000 / numSources);
+    printf("MS-BFS, %d sources per scan %9.3f s  %9.3f ms\n", MSBFS_LANES, batchTime, batchTime * 1000 / numSources);
+    printf("\nDistance sums %s\n", same ? "match" : "DIFFER");
+    
+    free(sources);
+    free(singleSum);
+    free(batchSum);
+    free(reached);
+    free(parent);
+    free(depth);
+    freeCSRGraph(graph);
+}
+
+// Function to check Afforest against BFS labeling on a sparse R-MAT graph
+// (with many components) and a path split in two, where sampling finds no
+// giant component
+bool checkComponents(int scale, int edgeFactor, uint32_t seed) {
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, seed);
+    int V = graph->numVertices;
+    int* expected = (int*)malloc(V * sizeof(int));
+    int* label = (int*)malloc(V * sizeof(int));
+    bool ok = componentsBFS(graph, expected) == connectedComponents(graph, label, 4)
+        && sameComponents(V, expected, label);
+    freeCSRGraph(graph);
+    
+    int* src = (int*)calloc(V, sizeof(int));
+    int* dest = (int*)calloc(V, sizeof(int));
+    int numEdges = 0;
+    for (int v = 0; v + 1 < V; v++) {
+        if (v != V / 2) {
+            src[numEdges] = v;
+            dest[numEdges++] = v + 1;
+        }
+    }
+    graph = createCSRGraph(V, numEdges, src, dest);
+    ok = ok && connectedComponents(graph, label, 3) == 2 && componentsBFS(graph, expected) == 2
+        && sameComponents(V, expected, label);
+    freeCSRGraph(graph);
+    
+    free(src);
+    free(dest);
+    free(expected);
+    free(label);
+    return ok;
+}
+
+// Function to relabel a CSR graph: vertex v becomes newId[v]
+struct CSRGraph* relabelCSRGraph(const struct CSRGraph* graph, const int newId[]) {
+    struct CSRGraph* relabelled = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    relabelled->numVertices = graph->numVertices;
+    relabelled->numEdges = graph->numEdges;
+    relabelled->rowStart = (int*)malloc(((size_t)graph->numVertices + 1) * sizeof(int));
+    relabelled->adj = (int*)malloc(((size_t)graph->numEdges + 1) * sizeof(int));
+    relabelled->directed = graph->directed;
+    permuteCSR(graph->numVertices, graph->rowStart, graph->adj, NULL, newId,
+               relabelled->rowStart, relabelled->adj, NULL);
+    return relabelled;
+}
+
+// Function to map a BFS on a relabelled graph back to the input numbering
+void mapBFSBack(int V, const int newId[], const int oldId[], const int parent[], const int depth[],
+                int mappedParent[], int mappedDepth[]) {
+    for (int v = 0; v < V; v++) {
+        mappedDepth[v] = depth[newId[v]];
+        mappedParent[v] = parent[newId[v]] >= 0 ? oldId[parent[newId[v]]] : -1;
+    }
+}
+
+// Function to check that BFS on every reordering of an R-MAT graph, mapped
+// back through the permutation, gives the depths of the input numbering
+bool checkReorder(int scale, int edgeFactor, uint32_t seed) {
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, seed);
+    int V = graph->numVertices;
+    int* newId = (int*)malloc(V * sizeof(int));
+    int* oldId = (int*)malloc(V * sizeof(int));
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* depth = (int*)malloc(V * sizeof(int));
+    int* mappedParent = (int*)malloc(V * sizeof(int));
+    int* mappedDepth = (int*)malloc(V * sizeof(int));
+    int* expected = (int*)malloc(V * sizeof(int));
+    uint32_t state = seed;
+    int source = xorshift32(&state) % V;
+    bfsCSR(graph, source, parent, expected, TOP_DOWN, NULL);
+    
+    bool ok = true;
+    for (int t = REORDER_DEGREE; t < NUM_REORDER_TYPES && ok; t++) {
+        computeOrder((enum ReorderType)t, V, graph->rowStart, graph->adj, seed, newId);
+        ok = isPermutation(V, newId);
+        if (!ok)
+            break;
+        inversePermutation(V, newId, oldId);
+        struct CSRGraph* relabelled = relabelCSRGraph(graph, newId);
+        bfsCSR(relabelled, newId[source], parent, depth, DIRECTION_OPTIMIZING, NULL);
+        mapBFSBack(V, newId, oldId, parent, depth, mappedParent, mappedDepth);
+        ok = checkBFSTree(graph, source, mappedParent, mappedDepth, expected);
+        freeCSRGraph(relabelled);
+    }
+    free(newId);
+    free(oldId);
+    free(parent);
+    free(depth);
+    free(mappedParent);
+    free(mappedDepth);
+    free(expected);
+    freeCSRGraph(graph);
+    return ok;
+}
+
+// Function to compare top-down and direction-optimizing BFS on an R-MAT
+// graph in its input numbering and after each reordering
+void benchmarkReorder(int scale, int edgeFactor, int numSources) {
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, 1);
+    int V = graph->numVertices;
+    printf("R-MAT graph: %d vertices, %d stored edges, %d sources\n", V, graph->numEdges, numSources);
+    
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    int* expected = (int*)malloc((size_t)numSources * V * sizeof(int));
+    int* newId = (int*)malloc(V * sizeof(int));
+    int* oldId = (int*)malloc(V * sizeof(int));
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* depth = (int*)malloc(V * sizeof(int));
+    uint32_t state = 12345;
+    for (int i = 0; i < numSources; i++) {
+        do {
+            sources[i] = xorshift32(&state) % V;
+        } while (graph->rowStart[sources[i] + 1] == graph->rowStart[sources[i]]);
+        bfsCSR(graph, sources[i], parent, expected + (size_t)i * V, TOP_DOWN, NULL);
+    }
+    
+    int counter = openCacheMissCounter();
+    if (counter < 0)
+        printf("(Hardware cache miss counters are not available here)\n");
+    printf("\nOrder       Reorder   Avg edge gap   Top-down   Diropt   Cache misses/search   Depths\n");
+    for (int t = REORDER_NONE; t < REORDER_RANDOM; t++) {
+        double start = nowSeconds();
+        computeOrder((enum ReorderType)t, V, graph->rowStart, graph->adj, 1, newId);
+        struct CSRGraph* relabelled = relabelCSRGraph(graph, newId);
+        double reorderTime = nowSeconds() - start;
+        inversePermutation(V, newId, oldId);
+        
+        double time[2] = { 0, 0 };
+        long long misses = 0;
+        bool same = true;
+        for (int m = 0; m < 2; m++) {
+            for (int i = 0; i < numSources; i++) {
+                startCacheMissCounter(counter);
+                start = nowSeconds();
+                bfsCSR(relabelled, newId[sources[i]], parent, depth, (enum BFSMode)m, NULL);
+                time[m] += nowSeconds() - start;
+                misses += stopCacheMissCounter(counter);
+                for (int v = 0; v < V && same; v++)
+                    same = depth[newId[v]] == expected[(size_t)i * V + v];
+            }
+        }
+        char missText[32] = "n/a";
+        if (counter >= 0)
+            snprintf(missText, sizeof(missText), "%lld", misses / (2 * numSources));
+        printf("%-10s %6.2f s   %12.1f  %6.2f ms %6.2f ms   %19s   %s\n", reorderName((enum ReorderType)t),
+               reorderTime, averageEdgeGap(V, relabelled->rowStart, relabelled->adj),
+               time[0] * 1000 / numSources, time[1] * 1000 / numSources, missText, same ? "match" : "DIFFER");
+        freeCSRGraph(relabelled);
+    }
+    closeCacheMissCounter(counter);
+    
+    free(sources);
+    free(expected);
+    free(newId);
+    free(oldId);
+    free(parent);
+    free(depth);
+    freeCSRGraph(graph);
+}
+
+// Function to compare Afforest against BFS labeling on an R-MAT graph
+void benchmarkComponents(int scale, int edgeFactor, int numThreads) {
+    printf("R-MAT graph: 2^%d vertices, %d x 2^%d undirected edges, %d threads\n",
+           scale, edgeFactor, scale, numThreads);
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, 1);
+    int V = graph->numVertices;
+    int* expected = (int*)malloc(V * sizeof(int));
+    int* label = (int*)malloc(V * sizeof(int));
+    
+    double start = nowSeconds();
+    int expectedCount = componentsBFS(graph, expected);
+    double bfsTime = nowSeconds() - start;
+    start = nowSeconds();
+    int count = connectedComponents(graph, label, numThreads);
+    double afforestTime = nowSeconds() - start;
+    
+    printf("Stored edges: %d\n\n", graph->numEdges);
+    printf("Method                   Time     Components\n");
+    printf("BFS from each vertex  %7.3f s   %d\n", bfsTime, expectedCount);
+    printf("Afforest              %7.3f s   %d\n", afforestTime, count);
+    printf("\nLabels %s\n", count == expectedCount && sameComponents(V, expected, label) ? "match" : "DIFFER");
+    
+    free(expected);
+    free(label);
+    freeCSRGraph(graph);
+}
+
+// Number of CPUs available to run threads on
+int numCPUs() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+// Edges traversed by a search for TEPS: the edges with a reached endpoint
+// (each undirected edge is stored twice, so half the stored ones)
+long long traversedEdges(const struct CSRGraph* graph, const int depth[]) {
+    long long edges = 0;
+    for (int v = 0; v < graph->numVertices; v++)
+        if (depth[v] != -1)
+            edges += graph->rowStart[v + 1] - graph->rowStart[v];
+    return graph->directed ? edges : edges / 2;
+}
+
+// Function to compare top-down, direction-optimizing and parallel bitmap
+// BFS on an R-MAT graph, searching from several random non-isolated sources
+void benchmark(int scale, int edgeFactor, int numSources, int numThreads) {
+    printf("R-MAT graph: 2^%d vertices, %d x 2^%d undirected edges, %d threads\n",
+           scale, edgeFactor, scale, numThreads);
+    double start = nowSeconds();
+    struct CSRGraph* graph = createRMATGraph(scale, edgeFactor, 1);
+    int V = graph->numVertices;
+    printf("Generated %d vertices, %d stored edges in %.2f s\n\n", V, graph->numEdges, nowSeconds() - start);
+    
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* depth = (int*)malloc(V * sizeof(int));
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    uint32_t state = 12345;
+    for (int i = 0; i < numSources; i++) {
+        do {
+            sources[i] = xorshift32(&state) % V;
+        } while (graph->rowStart[sources[i] + 1] == graph->rowStart[sources[i]]);
+    }
+    
+    const char* names[3] = { "top-down", "direction-optimizing", "parallel bitmap" };
+    printf("Mode                    Time/search   Edges checked   Levels (bottom-up)      MTEPS\n");
+    for (int m = 0; m < 3; m++) {
+        double total = 0;
+        long long edges = 0, traversed = 0;
+        struct BFSStats stats;
+        for (int i = 0; i < numSources; i++) {
+            start = nowSeconds();
+            if (m == 2)
+                bfsParallel(graph, sources[i], parent, depth, numThreads, &stats);
+            else
+                bfsCSR(graph, sources[i], parent, depth, (enum BFSMode)m, &stats);
+            total += nowSeconds() - start;
+            edges += stats.edgesChecked;
+            traversed += traversedEdges(graph, depth);
+        }
+        printf("%-22s %9.2f ms   %13lld   %6d (%d) %16.1f\n", names[m], total * 1000 / numSources,
+               edges / numSources, stats.levels, stats.bottomUpLevels, traversed / total * 1e-6);
+    }
+    
+    free(parent);
+    free(depth);
+    free(sources);
+    freeCSRGraph(graph);
+}
+
+// Run BFS on a memory-mapped graph file with the CSR version
+// The CSRGraph borrows the arrays of the mapping, so loading copies nothing
+// numThreads > 0 selects the parallel bitmap version
+bool searchGraphFile(const char* path, int source, enum BFSMode mode, int numThreads) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return false;
+    if (source < 0 || source >= file->numVertices) {
+        printf("Start vertex must be between 0 and %d\n", file->numVertices - 1);
+        closeGraphFile(file);
+        return false;
+    }
+    struct CSRGraph graph = { file->numVertices, file->numEdges, file->rowStart, file->adj, file->directed };
+    printf("Mapped %s: %d vertices, %d edges%s\n", path, graph.numVertices, graph.numEdges,
+           graph.directed ? " (directed, top-down only)" : "");
+    
+    int* parent = (int*)malloc(graph.numVertices * sizeof(int));
+    int* depth = (int*)malloc(graph.numVertices * sizeof(int));
+    struct BFSStats stats;
+    double start = nowSeconds();
+    if (numThreads > 0)
+        bfsParallel(&graph, source, parent, depth, numThreads, &stats);
+    else
+        bfsCSR(&graph, source, parent, depth, mode, &stats);
+    double time = nowSeconds() - start;
+    
+    if (graph.numVertices <= 20) {
+        printf("\nVertex \t Depth \t Parent\n");
+        for (int v = 0; v < graph.numVertices; v++)
+            printf("%d \t %d \t %d\n", v, depth[v], parent[v]);
+    }
+    printf("\nReached %d of %d vertices from %d in %d levels (%d bottom-up), %lld edges checked (%.3f s, %.1f MTEPS)\n",
+           stats.reached, graph.numVertices, source, stats.levels, stats.bottomUpLevels,
+           stats.edgesChecked, time, traversedEdges(&graph, depth) / time * 1e-6);
+    
+    free(parent);
+    free(depth);
+    closeGraphFile(file);
+    return true;
+}
+
 // Driver program to test BFS
-int main() {
-    /* Example graph:
-         0 --- 1
-         |     |
-         |     |
-         2 --- 3
-    */
+// Usage: ./4_bfs [graphFile [startVertex]]
+//        ./4_bfs file graphFile [startVertex] [topdown|diropt|parallel]
+//        ./4_bfs bench [scale] [edgeFactor] [sources] [threads]
+//        ./4_bfs bench-msbfs [scale] [edgeFactor] [sources]
+//        ./4_bfs bench-cc [scale] [edgeFactor] [threads]
+//        ./4_bfs bench-reorder [scale] [edgeFactor] [sources]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "bench-cc") == 0) {
+        int scale = argc > 2 ? atoi(argv[2]) : 22;
+        int edgeFactor = argc > 3 ? atoi(argv[3]) : 16;
+        int threads = argc > 4 ? atoi(argv[4]) : numCPUs();
+        if (scale < 1 || scale > 26 || edgeFactor < 1 || (long long)edgeFactor << (scale + 1) > INT32_MAX
+            || threads < 1) {
+            printf("Benchmark needs 1 <= scale <= 26, edgeFactor >= 1 with 2 * edgeFactor * 2^scale < 2^31, threads >= 1\n");
+            return 1;
+        }
+        benchmarkComponents(scale, edgeFactor, threads);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "bench-reorder") == 0) {
+        int scale = argc > 2 ? atoi(argv[2]) : 20;
+        int edgeFactor = argc > 3 ? atoi(argv[3]) : 16;
+        int numSources = argc > 4 ? atoi(argv[4]) : 8;
+        if (scale < 1 || scale > 26 || edgeFactor < 1 || (long long)edgeFactor << (scale + 1) > INT32_MAX
+            || numSources < 1 || (long long)numSources << scale > INT32_MAX) {
+            printf("Benchmark needs 1 <= scale <= 26, edgeFactor >= 1 with 2 * edgeFactor * 2^scale < 2^31, 1 <= sources * 2^scale < 2^31\n");
+            return 1;
+        }
+        benchmarkReorder(scale, edgeFactor, numSources);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "bench-msbfs") == 0) {
+        int scale = argc > 2 ? atoi(argv[2]) : 18;
+        int edgeFactor = argc > 3 ? atoi(argv[3]) : 16;
+        int numSources = argc > 4 ? atoi(argv[4]) : 1024;
+        if (scale < 1 || scale > 26 || edgeFactor < 1 || (long long)edgeFactor << (scale + 1) > INT32_MAX
+            || numSources < 1) {
+            printf("Benchmark needs 1 <= scale <= 26, edgeFactor >= 1 with 2 * edgeFactor * 2^scale < 2^31, sources >= 1\n");
+            return 1;
+        }
+        benchmarkMultiSource(scale, edgeFactor, numSources);
+        return 0;
+    }
     
-    struct Graph* graph = createGraph(4);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int scale = argc > 2 ? atoi(argv[2]) : 22;
+        int edgeFactor = argc > 3 ? atoi(argv[3]) : 16;
+        int numSources = argc > 4 ? atoi(argv[4]) : 8;
+        int threads = argc > 5 ? atoi(argv[5]) : numCPUs();
+        if (scale < 1 || scale > 26 || edgeFactor < 1 || (long long)edgeFactor << (scale + 1) > INT32_MAX
+            || numSources < 1 || threads < 1) {
+            printf("Benchmark needs 1 <= scale <= 26, edgeFactor >= 1 with 2 * edgeFactor * 2^scale < 2^31, sources, threads >= 1\n");
+            return 1;
+        }
+        benchmark(scale, edgeFactor, numSources, threads);
+        return 0;
+    }
     
-    addEdge(graph, 0, 1);
-    addEdge(graph, 0, 2);
-    addEdge(graph, 1, 3);
-    addEdge(graph, 2, 3);
+    if (argc > 2 && strcmp(argv[1], "file") == 0) {
+        int source = argc > 3 ? atoi(argv[3]) : 0;
+        enum BFSMode mode = DIRECTION_OPTIMIZING;
+        int threads = 0;
+        if (argc > 4 && strcmp(argv[4], "topdown") == 0)
+            mode = TOP_DOWN;
+        else if (argc > 4 && strcmp(argv[4], "parallel") == 0)
+            threads = numCPUs();
+        else if (argc > 4 && strcmp(argv[4], "diropt") != 0) {
+            printf("Unknown mode %s (topdown, diropt or parallel)\n", argv[4]);
+            return 1;
+        }
+        printf("Breadth First Search (BFS) Graph Traversal\n");
+        printf("===========================================\n\n");
+        return searchGraphFile(argv[2], source, mode, threads) ? 0 : 1;
+    }
+    
+    struct Graph* graph;
+    int startVertex = 0;
+    
+    if (argc > 1) {
+        graph = loadGraphFile(argv[1]);
+        if (graph == NULL)
+            return 1;
+        startVertex = argc > 2 ? atoi(argv[2]) : 0;
+        if (startVertex < 0 || startVertex >= graph->numVertices) {
+            printf("Start vertex must be between 0 and %d\n", graph->numVertices - 1);
+            return 1;
+        }
+    } else {
+        /* Example graph:
+             0 --- 1
+             |     |
+             |     |
+             2 --- 3
+        */
+        graph = createGraph(4);
+        
+        addEdge(graph, 0, 1);
+        addEdge(graph, 0, 2);
+        addEdge(graph, 1, 3);
+        addEdge(graph, 2, 3);
+    }
     
     printf("Breadth First Search (BFS) Graph Traversal\n");
     printf("===========================================\n\n");
     
-    BFS(graph, 0);
+    BFS(graph, startVertex);
     
     // Free allocated memory
-    for (int i = 0; i < graph->numVertices; i++)
-        free(graph->adjMatrix[i]);
-    free(graph->adjMatrix);
-    free(graph);
+    freeGraph(graph);
+    
+    // Cross-check direction-optimizing and parallel BFS against top-down BFS
+    printf("\nChecking direction-optimizing and parallel BFS against top-down: %s\n",
+           checkDirectionOptimizing(12, 8, 1) && checkDirectionOptimizing(14, 4, 2) ? "PASSED" : "FAILED");
+    printf("Checking multi-source BFS against one BFS per source: %s\n",
+           checkMultiSource(11, 4, 150, 3) ? "PASSED" : "FAILED");
+    printf("Checking parallel connected components against BFS labeling: %s\n",
+           checkComponents(14, 1, 4) && checkComponents(12, 8, 5) ? "PASSED" : "FAILED");
+    printf("Checking BFS on reordered graphs mapped back to the input numbering: %s\n",
+           checkReorder(12, 8, 6) && checkReorder(13, 2, 7) ? "PASSED" : "FAILED");
     
     return 0;
 }
@@ -16,16 +16,114 @@
  *    c. For each adjacent vertex, if it has not been visited:
  *       - Mark it as visited
  *       - Push it to S
+ *
+ * The recursive version needs one C stack frame per vertex on the current
+ * path, which overflows on long paths. The CSR engine (dfsBegin() and
+ * dfsNext()) keeps its own stack of frames instead, one per vertex on the
+ * path, each holding (vertex, offset of the next edge to try):
+ * 1. Push the root with its first edge offset and give it a discovery time
+ * 2. While the stack is not empty, look at the top frame (u, e):
+ *    a. If u has edges left, take edge e, advance the offset, and if its
+ *       target v is undiscovered, discover v and push (v, first edge of v)
+ *    b. Otherwise pop u and give it a finish time
+ * Every vertex is pushed once and every edge taken once, so the engine runs
+ * in O(V + E) time with at most V frames. Discovery and finish times come
+ * from one clock, so u is an ancestor of v exactly when
+ * discovery[u] <= discovery[v] and finish[v] <= finish[u].
+ * dfsNext() returns one event per step (discover, finish or non-tree edge),
+ * so analyses can be written as a loop over the events. Each of these is
+ * one DFS forest with a few int arrays of V entries, so O(V + E):
+ * - Strongly connected components (Tarjan, directed graphs): low[v] is the
+ *   smallest discovery time reachable from v's subtree through one edge to
+ *   a vertex still on the component stack. A vertex with
+ *   low[v] == discovery[v] is the first of its component, which is popped
+ *   from the stack when v finishes
+ * - Articulation points and bridges (undirected graphs): low[v] is the
+ *   smallest discovery time reachable from v's subtree with one back edge.
+ *   Tree edge p - v is a bridge if low[v] > discovery[p], and p is an
+ *   articulation point if low[v] >= discovery[p] for some child v (a root
+ *   needs two children). Only one copy of the edge back to the parent is
+ *   skipped, so parallel edges are never bridges
+ * - Topological sort (directed graphs): vertices in decreasing finish time;
+ *   an edge to a discovered but unfinished vertex closes a cycle
+ *
+ * benchmarkReorder() renumbers the vertices of a grid whose input numbering
+ * is random (like a road network in arbitrary order) with the orders of
+ * graph_reorder.h and times the DFS forest and the articulation point
+ * search on every numbering. The articulation points are mapped back
+ * through the permutation and must be the same vertices every time.
+ *
+ * The adjacency matrix holds one bit per vertex pair in a single
+ * cache-aligned allocation (32 times smaller than one int per entry), and
+ * both matrix versions enumerate a row 64 columns at a time with
+ * count-leading/trailing-zeros instructions instead of testing every column.
+ *
+ * The graph can also be read from a graph file (see graph_file.h). The
+ * matrix version copies its edges into the adjacency matrix, so files are
+ * limited to MAX_FILE_VERTICES vertices; the CSR engine uses the arrays of
+ * the mapped file in place.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "graph_file.h"
+#include "graph_reorder.h"
 
-// Structure to represent a graph
+#define MAX_FILE_VERTICES 32768 // Largest graph file loaded into a matrix (128 MB of bits)
+#define MATRIX_ROW_ALIGN_WORDS 8 // Matrix rows start on 64-byte cache lines
+
+// Structure to represent a graph as a bit-packed adjacency matrix
+// Bit v of row u is set if u - v is an edge. All rows share one allocation
+// and each starts on a cache line
 struct Graph {
     int numVertices;
-    int** adjMatrix;
+    int rowWords;       // 64-bit words per row, a multiple of MATRIX_ROW_ALIGN_WORDS
+    uint64_t* adjBits;  // Row u is adjBits[u * rowWords .. (u+1) * rowWords - 1]
+};
+
+// Structure to represent an unweighted graph in CSR form
+struct CSRGraph {
+    int numVertices;
+    int numEdges;   // Stored edges (twice the number of undirected edges)
+    int* rowStart;  // rowStart[u] .. rowStart[u+1]-1 index the neighbours of u
+    int* adj;
+    bool directed;  // Rows hold only outgoing edges
+};
+
+// One vertex on the path of the DFS engine
+struct DFSFrame {
+    int vertex;
+    int nextEdge;   // Offset in adj[] of the next edge to try
+};
+
+// What dfsNext() reports
+enum DFSEventType {
+    DFS_DISCOVER,       // vertex entered through edge from other (-1 for roots)
+    DFS_FINISH,         // All edges of vertex done; other is its parent
+    DFS_NON_TREE_EDGE   // Edge from vertex to the already discovered other
+};
+
+struct DFSEvent {
+    enum DFSEventType type;
+    int vertex;
+    int other;
+    int edge;           // Offset in adj[] of the edge (-1 for roots and finishes)
+};
+
+// State of a depth-first search over a CSR graph
+struct DFSIterator {
+    const struct CSRGraph* graph;
+    struct DFSFrame* stack;  // At most one frame per vertex
+    int top;                 // Index of the top frame, -1 if empty
+    int* parent;             // parent[v], -1 for roots and undiscovered vertices
+    int* discovery;          // discovery[v], -1 until v is discovered
+    int* finish;             // finish[v], -1 until v is finished
+    int clock;               // Next timestamp
+    int nextRoot;            // Next vertex to try as a root, or -1 for one tree only
 };
 
 // Function to create a graph with n vertices
@@ -33,21 +131,52 @@ struct Graph* createGraph(int vertices) {
     struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
     graph->numVertices = vertices;
     
-    // Allocate memory for adjacency matrix
-    graph->adjMatrix = (int**)malloc(vertices * sizeof(int*));
-    for (int i = 0; i < vertices; i++) {
-        graph->adjMatrix[i] = (int*)malloc(vertices * sizeof(int));
-        for (int j = 0; j < vertices; j++)
-            graph->adjMatrix[i][j] = 0;
-    }
+    // One bit per matrix entry, rows padded to whole cache lines
+    int words = (vertices + 63) / 64;
+    graph->rowWords = (words + MATRIX_ROW_ALIGN_WORDS - 1) / MATRIX_ROW_ALIGN_WORDS * MATRIX_ROW_ALIGN_WORDS;
+    size_t bytes = (size_t)vertices * graph->rowWords * sizeof(uint64_t);
+    graph->adjBits = (uint64_t*)aligned_alloc(64, bytes > 0 ? bytes : 64);
+    memset(graph->adjBits, 0, bytes);
     
     return graph;
 }
 
+// Function to free a graph
+void freeGraph(struct Graph* graph) {
+    free(graph->adjBits);
+    free(graph);
+}
+
+// Row of u in the adjacency matrix
+static inline uint64_t* matrixRow(const struct Graph* graph, int u) {
+    return graph->adjBits + (size_t)u * graph->rowWords;
+}
+
 // Function to add an edge to the graph
 void addEdge(struct Graph* graph, int src, int dest) {
-    graph->adjMatrix[src][dest] = 1;
-    graph->adjMatrix[dest][src] = 1;  // For undirected graph
+    matrixRow(graph, src)[dest >> 6] |= 1ull << (dest & 63);
+    matrixRow(graph, dest)[src >> 6] |= 1ull << (src & 63);  // For undirected graph
+}
+
+// Function to load a graph file into an adjacency matrix graph
+// Returns NULL (after printing why) if the file cannot be used
+struct Graph* loadGraphFile(const char* path) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return NULL;
+    if (file->numVertices < 1 || file->numVertices > MAX_FILE_VERTICES) {
+        printf("Graph has %d vertices, the matrix version handles 1 to %d\n",
+               file->numVertices, MAX_FILE_VERTICES);
+        closeGraphFile(file);
+        return NULL;
+    }
+    
+    struct Graph* graph = createGraph(file->numVertices);
+    for (int u = 0; u < file->numVertices; u++)
+        for (int e = file->rowStart[u]; e < file->rowStart[u + 1]; e++)
+            addEdge(graph, u, file->adj[e]);
+    closeGraphFile(file);
+    return graph;
 }
 
 // Recursive DFS traversal helper function
@@ -56,10 +185,14 @@ void DFSUtil(struct Graph* graph, int vertex, bool visited[]) {
     visited[vertex] = true;
     printf("%d ", vertex);
     
-    // Recur for all the vertices adjacent to this vertex
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->adjMatrix[vertex][i] == 1 && !visited[i]) {
-            DFSUtil(graph, i, visited);
+    // Recur for all the vertices adjacent to this vertex, taking the set
+    // bits of its row in increasing order
+    const uint64_t* row = matrixRow(graph, vertex);
+    for (int w = 0; w < graph->rowWords; w++) {
+        for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            if (!visited[i])
+                DFSUtil(graph, i, visited);
         }
     }
 }
@@ -86,8 +219,13 @@ void DFS_Iterative(struct Graph* graph, int startVertex) {
         visited[i] = false;
     
     // Create a stack for DFS
-    int* stack = (int*)malloc(graph->numVertices * sizeof(int));
-    int top = -1;
+    // A vertex is pushed once per visited neighbour, so the stack can hold
+    // one entry per matrix entry plus the start vertex
+    long long edgeCount = 0;
+    for (size_t w = 0; w < (size_t)graph->numVertices * graph->rowWords; w++)
+        edgeCount += __builtin_popcountll(graph->adjBits[w]);
+    int* stack = (int*)malloc((edgeCount + 1) * sizeof(int));
+    long long top = -1;
     
     // Push the starting vertex to stack
     stack[++top] = startVertex;
@@ -105,10 +243,15 @@ void DFS_Iterative(struct Graph* graph, int startVertex) {
         }
         
         // Get all adjacent vertices of the popped vertex
-        // Push unvisited adjacent vertices to stack
-        for (int i = graph->numVertices - 1; i >= 0; i--) {
-            if (graph->adjMatrix[currentVertex][i] == 1 && !visited[i]) {
-                stack[++top] = i;
+        // Push unvisited adjacent vertices to stack, highest first (highest
+        // set bit of each word from the last word down), so the lowest is on top
+        const uint64_t* row = matrixRow(graph, currentVertex);
+        for (int w = graph->rowWords - 1; w >= 0; w--) {
+            for (uint64_t bits = row[w]; bits != 0; ) {
+                int bit = 63 - __builtin_clzll(bits);
+                bits &= ~(1ull << bit);
+                if (!visited[w * 64 + bit])
+                    stack[++top] = w * 64 + bit;
             }
         }
     }
@@ -118,33 +261,1007 @@ void DFS_Iterative(struct Graph* graph, int startVertex) {
     free(stack);
 }
 
+// Function to build an undirected CSR graph from an edge list (src[i] - dest[i])
+// Edges are bucketed by endpoint with a counting sort, so this runs in O(V + E)
+struct CSRGraph* createCSRGraph(int numVertices, int numEdges, const int src[], const int dest[]) {
+    struct CSRGraph* graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    graph->numVertices = numVertices;
+    graph->numEdges = 2 * numEdges;
+    graph->rowStart = (int*)calloc(numVertices + 1, sizeof(int));
+    graph->adj = (int*)malloc(2 * (size_t)numEdges * sizeof(int));
+    graph->directed = false;
+    
+    // Count the degree of every vertex
+    for (int i = 0; i < numEdges; i++) {
+        graph->rowStart[src[i] + 1]++;
+        graph->rowStart[dest[i] + 1]++;
+    }
+    
+    // Prefix sum turns degrees into row offsets
+    for (int u = 0; u < numVertices; u++)
+        graph->rowStart[u + 1] += graph->rowStart[u];
+    
+    // Scatter both directions of every edge into their rows
+    int* next = (int*)malloc(numVertices * sizeof(int));
+    memcpy(next, graph->rowStart, numVertices * sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        graph->adj[next[src[i]]++] = dest[i];
+        graph->adj[next[dest[i]]++] = src[i];
+    }
+    free(next);
+    
+    return graph;
+}
+
+// Function to build a directed CSR graph from an edge list (src[i] -> dest[i])
+struct CSRGraph* createDirectedCSRGraph(int numVertices, int numEdges, const int src[], const int dest[]) {
+    struct CSRGraph* graph = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    graph->numVertices = numVertices;
+    graph->numEdges = numEdges;
+    graph->rowStart = (int*)calloc(numVertices + 1, sizeof(int));
+    graph->adj = (int*)malloc((size_t)numEdges * sizeof(int));
+    graph->directed = true;
+    for (int i = 0; i < numEdges; i++)
+        graph->rowStart[src[i] + 1]++;
+    for (int u = 0; u < numVertices; u++)
+        graph->rowStart[u + 1] += graph->rowStart[u];
+    int* next = (int*)malloc(numVertices * sizeof(int));
+    memcpy(next, graph->rowStart, numVertices * sizeof(int));
+    for (int i = 0; i < numEdges; i++)
+        graph->adj[next[src[i]]++] = dest[i];
+    free(next);
+    return graph;
+}
+
+// Function to free a CSR graph
+void freeCSRGraph(struct CSRGraph* graph) {
+    free(graph->rowStart);
+    free(graph->adj);
+    free(graph);
+}
+
+// Function to start a DFS from source, or over every vertex in order if
+// source is -1 (a DFS forest). The caller's arrays receive the parents and
+// timestamps as the search proceeds
+void dfsBegin(struct DFSIterator* it, const struct CSRGraph* graph, int source,
+              int parent[], int discovery[], int finish[]) {
+    it->graph = graph;
+    it->stack = (struct DFSFrame*)malloc(graph->numVertices * sizeof(struct DFSFrame));
+    it->top = -1;
+    it->parent = parent;
+    it->discovery = discovery;
+    it->finish = finish;
+    it->clock = 0;
+    for (int v = 0; v < graph->numVertices; v++) {
+        parent[v] = -1;
+        discovery[v] = -1;
+        finish[v] = -1;
+    }
+    it->nextRoot = source == -1 ? 0 : -1;
+    if (source != -1) {
+        // Entered by the first dfsNext() call
+        it->stack[0].vertex = source;
+        it->stack[0].nextEdge = -1;
+        it->top = 0;
+    }
+}
+
+void dfsEnd(struct DFSIterator* it) {
+    free(it->stack);
+    it->stack = NULL;
+}
+
+// Function to advance the search by one step
+// Returns false once every tree is finished
+bool dfsNext(struct DFSIterator* it, struct DFSEvent* event) {
+    const struct CSRGraph* graph = it->graph;
+    
+    // Start the next tree when the stack is empty
+    if (it->top == -1) {
+        if (it->nextRoot == -1)
+            return false;
+        while (it->nextRoot < graph->numVertices && it->discovery[it->nextRoot] != -1)
+            it->nextRoot++;
+        if (it->nextRoot == graph->numVertices)
+            return false;
+        it->stack[0].vertex = it->nextRoot;
+        it->stack[0].nextEdge = -1;
+        it->top = 0;
+    }
+    
+    struct DFSFrame* frame = &it->stack[it->top];
+    int u = frame->vertex;
+    if (frame->nextEdge == -1) {
+        // A root that has not been entered yet
+        frame->nextEdge = graph->rowStart[u];
+        it->discovery[u] = it->clock++;
+        *event = (struct DFSEvent){ DFS_DISCOVER, u, -1, -1 };
+        return true;
+    }
+    
+    if (frame->nextEdge < graph->rowStart[u + 1]) {
+        int e = frame->nextEdge++;
+        int v = graph->adj[e];
+        if (it->discovery[v] != -1) {
+            *event = (struct DFSEvent){ DFS_NON_TREE_EDGE, u, v, e };
+            return true;
+        }
+        it->parent[v] = u;
+        it->discovery[v] = it->clock++;
+        it->top++;
+        it->stack[it->top].vertex = v;
+        it->stack[it->top].nextEdge = graph->rowStart[v];
+        *event = (struct DFSEvent){ DFS_DISCOVER, v, u, e };
+        return true;
+    }
+    
+    // Every edge of u is done
+    it->top--;
+    it->finish[u] = it->clock++;
+    *event = (struct DFSEvent){ DFS_FINISH, u, it->parent[u], -1 };
+    return true;
+}
+
+// Function to run a DFS on a CSR graph from source (-1: every vertex)
+// Fills parent[], discovery[] and finish[] (-1 where unreached) and returns
+// the number of vertices reached
+int dfsCSR(const struct CSRGraph* graph, int source, int parent[], int discovery[], int finish[]) {
+    struct DFSIterator it;
+    struct DFSEvent event;
+    int reached = 0;
+    dfsBegin(&it, graph, source, parent, discovery, finish);
+    while (dfsNext(&it, &event))
+        if (event.type == DFS_DISCOVER)
+            reached++;
+    dfsEnd(&it);
+    return reached;
+}
+
+// Function to find the strongly connected components of a directed graph
+// (Tarjan). component[v] receives the component of v, numbered in the order
+// the components are completed (a reverse topological order of the
+// condensation); returns the number of components
+int stronglyConnectedComponents(const struct CSRGraph* graph, int component[]) {
+    int V = graph->numVertices;
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* discovery = (int*)malloc(V * sizeof(int));
+    int* finish = (int*)malloc(V * sizeof(int));
+    int* low = (int*)malloc(V * sizeof(int));
+    int* stack = (int*)malloc(V * sizeof(int));  // Vertices without a component yet
+    int top = 0, numComponents = 0;
+    for (int v = 0; v < V; v++)
+        component[v] = -1;
+    
+    struct DFSIterator it;
+    struct DFSEvent event;
+    dfsBegin(&it, graph, -1, parent, discovery, finish);
+    while (dfsNext(&it, &event)) {
+        int v = event.vertex;
+        if (event.type == DFS_DISCOVER) {
+            low[v] = discovery[v];
+            stack[top++] = v;
+        } else if (event.type == DFS_NON_TREE_EDGE) {
+            // Only vertices still on the stack share a component with v
+            int w = event.other;
+            if (component[w] == -1 && discovery[w] < low[v])
+                low[v] = discovery[w];
+        } else {
+            if (low[v] == discovery[v]) {
+                int w;
+                do {
+                    w = stack[--top];
+                    component[w] = numComponents;
+                } while (w != v);
+                numComponents++;
+            }
+            int p = event.other;
+            if (p != -1 && low[v] < low[p])
+                low[p] = low[v];
+        }
+    }
+    dfsEnd(&it);
+    
+    free(parent);
+    free(discovery);
+    free(finish);
+    free(low);
+    free(stack);
+    return numComponents;
+}
+
+// Function to find the articulation points and bridges of an undirected graph
+// isCut[v] is set to true for articulation points; the endpoints of every
+// bridge are written to bridgeU[] and bridgeV[] (at most V - 1 bridges) and
+// *numBridges receives their count. Returns the number of articulation points
+int articulationPointsAndBridges(const struct CSRGraph* graph, bool isCut[],
+                                 int bridgeU[], int bridgeV[], int* numBridges) {
+    int V = graph->numVertices;
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* discovery = (int*)malloc(V * sizeof(int));
+    int* finish = (int*)malloc(V * sizeof(int));
+    int* low = (int*)malloc(V * sizeof(int));
+    int* rootChildren = (int*)calloc(V, sizeof(int));
+    bool* skippedParent = (bool*)calloc(V, sizeof(bool));  // Edge back to the parent seen
+    int numCuts = 0;
+    *numBridges = 0;
+    for (int v = 0; v < V; v++)
+        isCut[v] = false;
+    
+    struct DFSIterator it;
+    struct DFSEvent event;
+    dfsBegin(&it, graph, -1, parent, discovery, finish);
+    while (dfsNext(&it, &event)) {
+        int v = event.vertex;
+        if (event.type == DFS_DISCOVER) {
+            low[v] = discovery[v];
+        } else if (event.type == DFS_NON_TREE_EDGE) {
+            int w = event.other;
+            if (w == parent[v] && !skippedParent[v])
+                skippedParent[v] = true;  // The tree edge seen from below
+            else if (discovery[w] < low[v])
+                low[v] = discovery[w];
+        } else {
+            int p = event.other;
+            if (p == -1)
+                continue;
+            if (low[v] < low[p])
+                low[p] = low[v];
+            if (low[v] > discovery[p]) {
+                bridgeU[*numBridges] = p;
+                bridgeV[*numBridges] = v;
+                (*numBridges)++;
+            }
+            if (parent[p] == -1) {
+                if (++rootChildren[p] == 2) {
+                    isCut[p] = true;
+                    numCuts++;
+                }
+            } else if (low[v] >= discovery[p] && !isCut[p]) {
+                isCut[p] = true;
+                numCuts++;
+            }
+        }
+    }
+    dfsEnd(&it);
+    
+    free(parent);
+    free(discovery);
+    free(finish);
+    free(low);
+    free(rootChildren);
+    free(skippedParent);
+    return numCuts;
+}
+
+// Function to sort a directed graph topologically into order[]
+// Returns false if the graph has a cycle (order[] is then incomplete)
+bool topologicalSort(const struct CSRGraph* graph, int order[]) {
+    int V = graph->numVertices;
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* discovery = (int*)malloc(V * sizeof(int));
+    int* finish = (int*)malloc(V * sizeof(int));
+    int next = V;  // Vertices are placed from the back as they finish
+    bool acyclic = true;
+    
+    struct DFSIterator it;
+    struct DFSEvent event;
+    dfsBegin(&it, graph, -1, parent, discovery, finish);
+    while (acyclic && dfsNext(&it, &event)) {
+        if (event.type == DFS_FINISH)
+            order[--next] = event.vertex;
+        else if (event.type == DFS_NON_TREE_EDGE && finish[event.other] == -1)
+            acyclic = false;  // Back edge to a vertex on the current path
+    }
+    dfsEnd(&it);
+    
+    free(parent);
+    free(discovery);
+    free(finish);
+    return acyclic;
+}
+
+// Recursive DFS over CSR with the same edge order as the engine, used to
+// check it on graphs small enough for the C stack
+void dfsRecursiveCSR(const struct CSRGraph* graph, int u, int parent[], int discovery[], int finish[],
+                     int* clock) {
+    discovery[u] = (*clock)++;
+    for (int e = graph->rowStart[u]; e < graph->rowStart[u + 1]; e++) {
+        int v = graph->adj[e];
+        if (discovery[v] == -1) {
+            parent[v] = u;
+            dfsRecursiveCSR(graph, v, parent, discovery, finish, clock);
+        }
+    }
+    finish[u] = (*clock)++;
+}
+
+// Simple xorshift random number generator (deterministic for a given seed)
+uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Function to create a random undirected graph with numEdges edges between
+// random vertices (not necessarily connected)
+struct CSRGraph* createRandomGraph(int numVertices, int numEdges, uint32_t seed) {
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    uint32_t state = seed;
+    for (int i = 0; i < numEdges; i++) {
+        src[i] = xorshift32(&state) % numVertices;
+        dest[i] = xorshift32(&state) % numVertices;
+    }
+    struct CSRGraph* graph = createCSRGraph(numVertices, numEdges, src, dest);
+    free(src);
+    free(dest);
+    return graph;
+}
+
+// Function to create a path 0 - 1 - ... - (n-1), the worst case for recursion
+struct CSRGraph* createPathGraph(int numVertices) {
+    int* src = (int*)malloc((numVertices - 1) * sizeof(int));
+    int* dest = (int*)malloc((numVertices - 1) * sizeof(int));
+    for (int i = 0; i < numVertices - 1; i++) {
+        src[i] = i;
+        dest[i] = i + 1;
+    }
+    struct CSRGraph* graph = createCSRGraph(numVertices, numVertices - 1, src, dest);
+    free(src);
+    free(dest);
+    return graph;
+}
+
+// Function to create a side x side grid where each edge is dropped with
+// probability 1/4 (leaving articulation points and bridges), and whose
+// vertices are numbered in random order
+struct CSRGraph* createShuffledGridGraph(int side, uint32_t seed) {
+    int V = side * side;
+    int* newId = (int*)malloc(V * sizeof(int));
+    int* src = (int*)malloc(2 * (size_t)V * sizeof(int));
+    int* dest = (int*)malloc(2 * (size_t)V * sizeof(int));
+    randomOrder(V, seed, newId);
+    uint32_t state = seed;
+    int numEdges = 0;
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int u = r * side + c;
+            if (c + 1 < side && xorshift32(&state) % 4 != 0) {
+                src[numEdges] = newId[u];
+                dest[numEdges++] = newId[u + 1];
+            }
+            if (r + 1 < side && xorshift32(&state) % 4 != 0) {
+                src[numEdges] = newId[u];
+                dest[numEdges++] = newId[u + side];
+            }
+        }
+    }
+    struct CSRGraph* graph = createCSRGraph(V, numEdges, src, dest);
+    free(newId);
+    free(src);
+    free(dest);
+    return graph;
+}
+
+// Function to relabel a CSR graph: vertex v becomes newId[v]
+struct CSRGraph* relabelCSRGraph(const struct CSRGraph* graph, const int newId[]) {
+    struct CSRGraph* relabelled = (struct CSRGraph*)malloc(sizeof(struct CSRGraph));
+    relabelled->numVertices = graph->numVertices;
+    relabelled->numEdges = graph->numEdges;
+    relabelled->rowStart = (int*)malloc(((size_t)graph->numVertices + 1) * sizeof(int));
+    relabelled->adj = (int*)malloc(((size_t)graph->numEdges + 1) * sizeof(int));
+    relabelled->directed = graph->directed;
+    permuteCSR(graph->numVertices, graph->rowStart, graph->adj, NULL, newId,
+               relabelled->rowStart, relabelled->adj, NULL);
+    return relabelled;
+}
+
+// Wall-clock time in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Function to check the engine against the recursive version on a random
+// graph: both take edges in the same order, so every timestamp must match
+bool checkEngine(int numVertices, int numEdges, uint32_t seed) {
+    struct CSRGraph* graph = createRandomGraph(numVertices, numEdges, seed);
+    int V = numVertices;
+    int* parent[2], *discovery[2], *finish[2];
+    for (int i = 0; i < 2; i++) {
+        parent[i] = (int*)malloc(V * sizeof(int));
+        discovery[i] = (int*)malloc(V * sizeof(int));
+        finish[i] = (int*)malloc(V * sizeof(int));
+    }
+    
+    dfsCSR(graph, -1, parent[0], discovery[0], finish[0]);
+    for (int v = 0; v < V; v++)
+        parent[1][v] = discovery[1][v] = finish[1][v] = -1;
+    int clock = 0;
+    for (int v = 0; v < V; v++)
+        if (discovery[1][v] == -1)
+            dfsRecursiveCSR(graph, v, parent[1], discovery[1], finish[1], &clock);
+    
+    bool ok = memcmp(parent[0], parent[1], V * sizeof(int)) == 0
+        && memcmp(discovery[0], discovery[1], V * sizeof(int)) == 0
+        && memcmp(finish[0], finish[1], V * sizeof(int)) == 0;
+    for (int i = 0; i < 2; i++) {
+        free(parent[i]);
+        free(discovery[i]);
+        free(finish[i]);
+    }
+    freeCSRGraph(graph);
+    return ok;
+}
+
+// Number of trees in a DFS forest, i.e. connected components if undirected
+int countTrees(const struct CSRGraph* graph) {
+    int V = graph->numVertices;
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* discovery = (int*)malloc(V * sizeof(int));
+    int* finish = (int*)malloc(V * sizeof(int));
+    dfsCSR(graph, -1, parent, discovery, finish);
+    int trees = 0;
+    for (int v = 0; v < V; v++)
+        if (parent[v] == -1)
+            trees++;
+    free(parent);
+    free(discovery);
+    free(finish);
+    return trees;
+}
+
+// Function to check the analyses against brute force on small random graphs:
+// SCCs by mutual reachability, articulation points and bridges by removing
+// each vertex or edge and counting components again
+bool checkAnalyses(int numVertices, int numEdges, uint32_t seed) {
+    int V = numVertices;
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    int* keptSrc = (int*)calloc(numEdges, sizeof(int));
+    int* keptDest = (int*)calloc(numEdges, sizeof(int));
+    uint32_t state = seed;
+    for (int i = 0; i < numEdges; i++) {
+        src[i] = xorshift32(&state) % V;
+        dest[i] = xorshift32(&state) % V;
+    }
+    int* component = (int*)malloc(V * sizeof(int));
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* finish = (int*)malloc(V * sizeof(int));
+    int* reach = (int*)malloc((size_t)V * V * sizeof(int));  // Discovery times, -1 if unreached
+    int* order = (int*)malloc(V * sizeof(int));
+    int* bridgeU = (int*)malloc(V * sizeof(int));
+    int* bridgeV = (int*)malloc(V * sizeof(int));
+    bool* isCut = (bool*)malloc(V * sizeof(bool));
+    bool ok = true;
+    
+    // SCCs: same component exactly when each reaches the other
+    struct CSRGraph* directed = createDirectedCSRGraph(V, numEdges, src, dest);
+    stronglyConnectedComponents(directed, component);
+    for (int u = 0; u < V; u++)
+        dfsCSR(directed, u, parent, reach + (size_t)u * V, finish);
+    for (int u = 0; u < V && ok; u++)
+        for (int v = 0; v < V && ok; v++)
+            ok = (component[u] == component[v]) == (reach[(size_t)u * V + v] != -1 && reach[(size_t)v * V + u] != -1);
+    
+    // Topological sort: fails on this graph exactly when an SCC has a cycle;
+    // on the DAG of edges from lower to higher vertex it must order every edge
+    bool hasCycle = false;
+    for (int i = 0; i < numEdges; i++)
+        hasCycle = hasCycle || component[src[i]] == component[dest[i]];
+    ok = ok && topologicalSort(directed, order) == !hasCycle;
+    freeCSRGraph(directed);
+    int numKept = 0;
+    for (int i = 0; i < numEdges; i++) {
+        if (src[i] != dest[i]) {
+            keptSrc[numKept] = src[i] < dest[i] ? src[i] : dest[i];
+            keptDest[numKept++] = src[i] < dest[i] ? dest[i] : src[i];
+        }
+    }
+    directed = createDirectedCSRGraph(V, numKept, keptSrc, keptDest);
+    ok = ok && topologicalSort(directed, order);
+    int* position = component;  // Reused: position of every vertex in order[]
+    for (int i = 0; i < V; i++)
+        position[order[i]] = i;
+    for (int i = 0; i < numKept && ok; i++)
+        ok = position[keptSrc[i]] < position[keptDest[i]];
+    freeCSRGraph(directed);
+    
+    // Articulation points and bridges
+    struct CSRGraph* graph = createCSRGraph(V, numEdges, src, dest);
+    int numBridges;
+    articulationPointsAndBridges(graph, isCut, bridgeU, bridgeV, &numBridges);
+    int trees = countTrees(graph);
+    freeCSRGraph(graph);
+    for (int x = 0; x < V && ok; x++) {
+        // Without x (left isolated, so one tree more unless x was isolated already)
+        int kept = 0, degree = 0;
+        for (int i = 0; i < numEdges; i++) {
+            if (src[i] != x && dest[i] != x) {
+                keptSrc[kept] = src[i];
+                keptDest[kept++] = dest[i];
+            } else if (src[i] != dest[i]) {
+                degree++;
+            }
+        }
+        struct CSRGraph* without = createCSRGraph(V, kept, keptSrc, keptDest);
+        int expectedTrees = degree == 0 ? trees : trees + 1;
+        ok = isCut[x] == (countTrees(without) > expectedTrees);
+        freeCSRGraph(without);
+    }
+    int foundBridges = 0;
+    for (int skip = 0; skip < numEdges && ok; skip++) {
+        int kept = 0;
+        for (int i = 0; i < numEdges; i++)
+            if (i != skip) {
+                keptSrc[kept] = src[i];
+                keptDest[kept++] = dest[i];
+            }
+        struct CSRGraph* without = createCSRGraph(V, kept, keptSrc, keptDest);
+        if (countTrees(without) > trees) {
+            foundBridges++;
+            bool listed = false;
+            for (int b = 0; b < numBridges && !listed; b++)
+                listed = (bridgeU[b] == src[skip] && bridgeV[b] == dest[skip])
+                    || (bridgeU[b] == dest[skip] && bridgeV[b] == src[skip]);
+            ok = listed;
+        }
+        freeCSRGraph(without);
+    }
+    ok = ok && foundBridges == numBridges;
+    
+    free(src);
+    free(dest);
+    free(keptSrc);
+    free(keptDest);
+    free(component);
+    free(parent);
+    free(finish);
+    free(reach);
+    free(order);
+    free(bridgeU);
+    free(bridgeV);
+    free(isCut);
+    return ok;
+}
+
+// Function to time SCCs and topological sort on random directed graphs and
+// articulation points and bridges on a random undirected graph
+void benchmarkAnalyses(int numVertices, int numEdges) {
+    int V = numVertices;
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    uint32_t state = 1;
+    for (int i = 0; i < numEdges; i++) {
+        src[i] = xorshift32(&state) % V;
+        dest[i] = xorshift32(&state) % V;
+    }
+    int* result = (int*)malloc(V * sizeof(int));
+    printf("Random graphs with %d vertices and %d edges\n\n", V, numEdges);
+    
+    struct CSRGraph* graph = createDirectedCSRGraph(V, numEdges, src, dest);
+    double start = nowSeconds();
+    int numComponents = stronglyConnectedComponents(graph, result);
+    printf("Strongly connected components: %d (%.3f s)\n", numComponents, nowSeconds() - start);
+    freeCSRGraph(graph);
+    
+    // Directing every edge from the lower to the higher vertex gives a DAG
+    for (int i = 0; i < numEdges; i++) {
+        if (src[i] > dest[i]) {
+            int t = src[i];
+            src[i] = dest[i];
+            dest[i] = t;
+        } else if (src[i] == dest[i]) {
+            if (dest[i] + 1 < V)
+                dest[i]++;
+            else
+                src[i]--;
+        }
+    }
+    graph = createDirectedCSRGraph(V, numEdges, src, dest);
+    start = nowSeconds();
+    bool acyclic = topologicalSort(graph, result);
+    printf("Topological sort of a DAG: %s (%.3f s)\n", acyclic ? "done" : "CYCLE FOUND", nowSeconds() - start);
+    freeCSRGraph(graph);
+    
+    graph = createCSRGraph(V, numEdges, src, dest);
+    bool* isCut = (bool*)malloc(V * sizeof(bool));
+    int* bridgeU = (int*)malloc(V * sizeof(int));
+    int* bridgeV = (int*)malloc(V * sizeof(int));
+    int numBridges;
+    start = nowSeconds();
+    int numCuts = articulationPointsAndBridges(graph, isCut, bridgeU, bridgeV, &numBridges);
+    printf("Articulation points: %d, bridges: %d (%.3f s)\n", numCuts, numBridges, nowSeconds() - start);
+    freeCSRGraph(graph);
+    
+    free(src);
+    free(dest);
+    free(result);
+    free(isCut);
+    free(bridgeU);
+    free(bridgeV);
+}
+
+// Function to check a relabelled graph against the input numbering: the
+// DFS forest must have as many trees, and the articulation points mapped
+// back through newId[] must be the same vertices with as many bridges
+bool sameAnalysesAfterReorder(const struct CSRGraph* graph, const struct CSRGraph* relabelled,
+                              const int newId[], int expectedTrees, const bool expectedCut[],
+                              int expectedBridges) {
+    int V = graph->numVertices;
+    bool* isCut = (bool*)malloc(V * sizeof(bool));
+    int* bridgeU = (int*)malloc(V * sizeof(int));
+    int* bridgeV = (int*)malloc(V * sizeof(int));
+    int numBridges;
+    articulationPointsAndBridges(relabelled, isCut, bridgeU, bridgeV, &numBridges);
+    bool ok = countTrees(relabelled) == expectedTrees && numBridges == expectedBridges;
+    for (int v = 0; v < V && ok; v++)
+        ok = isCut[newId[v]] == expectedCut[v];
+    free(isCut);
+    free(bridgeU);
+    free(bridgeV);
+    return ok;
+}
+
+// Function to check every reordering of a shuffled grid and of a random
+// graph against the analyses on the input numbering
+bool checkReorder(int side, uint32_t seed) {
+    bool ok = true;
+    for (int g = 0; g < 2 && ok; g++) {
+        struct CSRGraph* graph = g == 0 ? createShuffledGridGraph(side, seed)
+                                        : createRandomGraph(side * side, side * side, seed);
+        int V = graph->numVertices;
+        int* newId = (int*)malloc(V * sizeof(int));
+        bool* isCut = (bool*)malloc(V * sizeof(bool));
+        int* bridgeU = (int*)malloc(V * sizeof(int));
+        int* bridgeV = (int*)malloc(V * sizeof(int));
+        int numBridges;
+        articulationPointsAndBridges(graph, isCut, bridgeU, bridgeV, &numBridges);
+        int trees = countTrees(graph);
+        for (int t = REORDER_DEGREE; t < NUM_REORDER_TYPES && ok; t++) {
+            computeOrder((enum ReorderType)t, V, graph->rowStart, graph->adj, seed, newId);
+            ok = isPermutation(V, newId);
+            if (!ok)
+                break;
+            struct CSRGraph* relabelled = relabelCSRGraph(graph, newId);
+            ok = sameAnalysesAfterReorder(graph, relabelled, newId, trees, isCut, numBridges);
+            freeCSRGraph(relabelled);
+        }
+        free(newId);
+        free(isCut);
+        free(bridgeU);
+        free(bridgeV);
+        freeCSRGraph(graph);
+    }
+    return ok;
+}
+
+// Function to time the DFS forest and articulation points on a shuffled
+// grid in its input numbering and after each reordering
+void benchmarkReorder(int side, int runs) {
+    struct CSRGraph* graph = createShuffledGridGraph(side, 1);
+    int V = graph->numVertices;
+    printf("Grid with %d x %d vertices in random order, %d stored edges, %d runs\n", side, side,
+           graph->numEdges, runs);
+    
+    int* parent = (int*)malloc(V * sizeof(int));
+    int* discovery = (int*)malloc(V * sizeof(int));
+    int* finish = (int*)malloc(V * sizeof(int));
+    int* newId = (int*)malloc(V * sizeof(int));
+    bool* expectedCut = (bool*)malloc(V * sizeof(bool));
+    bool* isCut = (bool*)malloc(V * sizeof(bool));
+    int* bridgeU = (int*)malloc(V * sizeof(int));
+    int* bridgeV = (int*)malloc(V * sizeof(int));
+    int expectedBridges, numBridges;
+    articulationPointsAndBridges(graph, expectedCut, bridgeU, bridgeV, &expectedBridges);
+    int expectedTrees = countTrees(graph);
+    
+    int counter = openCacheMissCounter();
+    if (counter < 0)
+        printf("(Hardware cache miss counters are not available here)\n");
+    printf("\nOrder       Reorder   Avg edge gap   DFS forest   Cut points   Cache misses/run   Results\n");
+    for (int t = REORDER_NONE; t < REORDER_RANDOM; t++) {
+        double start = nowSeconds();
+        computeOrder((enum ReorderType)t, V, graph->rowStart, graph->adj, 1, newId);
+        struct CSRGraph* relabelled = relabelCSRGraph(graph, newId);
+        double reorderTime = nowSeconds() - start;
+        
+        double dfsTime = 0, cutTime = 0;
+        long long misses = 0;
+        for (int i = 0; i < runs; i++) {
+            startCacheMissCounter(counter);
+            start = nowSeconds();
+            dfsCSR(relabelled, -1, parent, discovery, finish);
+            dfsTime += nowSeconds() - start;
+            start = nowSeconds();
+            articulationPointsAndBridges(relabelled, isCut, bridgeU, bridgeV, &numBridges);
+            cutTime += nowSeconds() - start;
+            misses += stopCacheMissCounter(counter);
+        }
+        bool same = sameAnalysesAfterReorder(graph, relabelled, newId, expectedTrees, expectedCut, expectedBridges);
+        char missText[32] = "n/a";
+        if (counter >= 0)
+            snprintf(missText, sizeof(missText), "%lld", misses / runs);
+        printf("%-10s %6.2f s   %12.1f  %8.2f ms  %8.2f ms   %16s   %s\n", reorderName((enum ReorderType)t),
+               reorderTime, averageEdgeGap(V, relabelled->rowStart, relabelled->adj),
+               dfsTime * 1000 / runs, cutTime * 1000 / runs, missText, same ? "match" : "DIFFER");
+        freeCSRGraph(relabelled);
+    }
+    closeCacheMissCounter(counter);
+    
+    free(parent);
+    free(discovery);
+    free(finish);
+    free(newId);
+    free(expectedCut);
+    free(isCut);
+    free(bridgeU);
+    free(bridgeV);
+    freeCSRGraph(graph);
+}
+
+// Function to time the engine on a long path and on a random graph
+void benchmark(int numVertices, int numEdges) {
+    int* parent = (int*)malloc(numVertices * sizeof(int));
+    int* discovery = (int*)malloc(numVertices * sizeof(int));
+    int* finish = (int*)malloc(numVertices * sizeof(int));
+    
+    struct CSRGraph* graph = createPathGraph(numVertices);
+    double start = nowSeconds();
+    int reached = dfsCSR(graph, 0, parent, discovery, finish);
+    printf("Path with %d vertices: %d vertices on one DFS path, %.3f s\n", numVertices,
+           reached, nowSeconds() - start);
+    freeCSRGraph(graph);
+    
+    graph = createRandomGraph(numVertices, numEdges, 1);
+    start = nowSeconds();
+    reached = dfsCSR(graph, -1, parent, discovery, finish);
+    int roots = 0;
+    for (int v = 0; v < numVertices; v++)
+        if (parent[v] == -1)
+            roots++;
+    printf("Random graph with %d vertices, %d stored edges: %d vertices in %d trees, %.3f s\n",
+           numVertices, graph->numEdges, reached, roots, nowSeconds() - start);
+    freeCSRGraph(graph);
+    
+    free(parent);
+    free(discovery);
+    free(finish);
+}
+
+// Run the DFS engine on a memory-mapped graph file from source
+// The CSRGraph borrows the arrays of the mapping, so loading copies nothing
+bool searchGraphFile(const char* path, int source) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return false;
+    if (source < 0 || source >= file->numVertices) {
+        printf("Start vertex must be between 0 and %d\n", file->numVertices - 1);
+        closeGraphFile(file);
+        return false;
+    }
+    struct CSRGraph graph = { file->numVertices, file->numEdges, file->rowStart, file->adj, file->directed };
+    printf("Mapped %s: %d vertices, %d edges\n", path, graph.numVertices, graph.numEdges);
+    
+    int* parent = (int*)malloc(graph.numVertices * sizeof(int));
+    int* discovery = (int*)malloc(graph.numVertices * sizeof(int));
+    int* finish = (int*)malloc(graph.numVertices * sizeof(int));
+    double start = nowSeconds();
+    int reached = dfsCSR(&graph, source, parent, discovery, finish);
+    double time = nowSeconds() - start;
+    
+    if (graph.numVertices <= 20) {
+        printf("\nVertex \t Discovery \t Finish \t Parent\n");
+        for (int v = 0; v < graph.numVertices; v++)
+            printf("%d \t %d \t\t %d \t\t %d\n", v, discovery[v], finish[v], parent[v]);
+    }
+    printf("\nReached %d of %d vertices from %d (%.3f s)\n", reached, graph.numVertices, source, time);
+    
+    free(parent);
+    free(discovery);
+    free(finish);
+    closeGraphFile(file);
+    return true;
+}
+
+// Run the analyses that fit a memory-mapped graph file: SCCs and
+// topological sort if it is directed, articulation points and bridges if not
+bool analyzeGraphFile(const char* path) {
+    struct GraphFile* file = openGraphFile(path);
+    if (file == NULL)
+        return false;
+    struct CSRGraph graph = { file->numVertices, file->numEdges, file->rowStart, file->adj, file->directed };
+    int V = graph.numVertices;
+    printf("Mapped %s: %d vertices, %d edges, %s\n\n", path, V, graph.numEdges,
+           graph.directed ? "directed" : "undirected");
+    
+    double start = nowSeconds();
+    if (graph.directed) {
+        int* component = (int*)malloc(V * sizeof(int));
+        int numComponents = stronglyConnectedComponents(&graph, component);
+        int* size = (int*)calloc(numComponents > 0 ? numComponents : 1, sizeof(int));
+        int largest = 0;
+        for (int v = 0; v < V; v++)
+            if (++size[component[v]] > largest)
+                largest = size[component[v]];
+        printf("Strongly connected components: %d, largest has %d vertices\n", numComponents, largest);
+        bool acyclic = topologicalSort(&graph, component);
+        printf("Topological order: %s\n", acyclic ? "exists (the graph is a DAG)" : "none, the graph has a cycle");
+        if (acyclic && V <= 20) {
+            for (int i = 0; i < V; i++)
+                printf("%d ", component[i]);
+            printf("\n");
+        }
+        free(component);
+        free(size);
+    } else {
+        bool* isCut = (bool*)malloc(V * sizeof(bool));
+        int* bridgeU = (int*)malloc(V * sizeof(int));
+        int* bridgeV = (int*)malloc(V * sizeof(int));
+        int numBridges;
+        int numCuts = articulationPointsAndBridges(&graph, isCut, bridgeU, bridgeV, &numBridges);
+        printf("Articulation points: %d\n", numCuts);
+        if (V <= 20) {
+            for (int v = 0; v < V; v++)
+                if (isCut[v])
+                    printf("%d ", v);
+            printf("\n");
+        }
+        printf("Bridges: %d\n", numBridges);
+        for (int b = 0; b < numBridges && V <= 20; b++)
+            printf("%d - %d\n", bridgeU[b], bridgeV[b]);
+        free(isCut);
+        free(bridgeU);
+        free(bridgeV);
+    }
+    printf("(%.3f s)\n", nowSeconds() - start);
+    closeGraphFile(file);
+    return true;
+}
+
 // Driver program to test DFS
-int main() {
-    /* Example graph:
-         0 --- 1
-         |     |
-         |     |
-         2 --- 3
-    */
+// Usage: ./5_dfs [graphFile [startVertex]]
+//        ./5_dfs file graphFile [startVertex]
+//        ./5_dfs analyze graphFile
+//        ./5_dfs bench [V] [E]
+//        ./5_dfs bench-analysis [V] [E]
+//        ./5_dfs bench-reorder [side] [runs]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "bench-reorder") == 0) {
+        int side = argc > 2 ? atoi(argv[2]) : 2000;
+        int runs = argc > 3 ? atoi(argv[3]) : 3;
+        if (side < 2 || side > 16384 || runs < 1) {
+            printf("Benchmark needs 2 <= side <= 16384 and runs >= 1\n");
+            return 1;
+        }
+        benchmarkReorder(side, runs);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "bench-analysis") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 5000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 10000000;
+        if (numVertices < 2 || numEdges < 1 || numEdges > INT32_MAX / 2) {
+            printf("Benchmark needs V >= 2 and 1 <= E <= %d\n", INT32_MAX / 2);
+            return 1;
+        }
+        benchmarkAnalyses(numVertices, numEdges);
+        return 0;
+    }
     
-    struct Graph* graph = createGraph(4);
+    if (argc > 2 && strcmp(argv[1], "analyze") == 0) {
+        printf("Depth First Search (DFS) Graph Analysis\n");
+        printf("========================================\n\n");
+        return analyzeGraphFile(argv[2]) ? 0 : 1;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int numVertices = argc > 2 ? atoi(argv[2]) : 10000000;
+        int numEdges = argc > 3 ? atoi(argv[3]) : 50000000;
+        if (numVertices < 2 || numEdges < 1 || numEdges > INT32_MAX / 2) {
+            printf("Benchmark needs V >= 2 and 1 <= E <= %d\n", INT32_MAX / 2);
+            return 1;
+        }
+        benchmark(numVertices, numEdges);
+        return 0;
+    }
+    
+    if (argc > 2 && strcmp(argv[1], "file") == 0) {
+        printf("Depth First Search (DFS) Graph Traversal\n");
+        printf("=========================================\n\n");
+        return searchGraphFile(argv[2], argc > 3 ? atoi(argv[3]) : 0) ? 0 : 1;
+    }
     
-    addEdge(graph, 0, 1);
-    addEdge(graph, 0, 2);
-    addEdge(graph, 1, 3);
-    addEdge(graph, 2, 3);
+    struct Graph* graph;
+    int startVertex = 0;
+    
+    if (argc > 1) {
+        graph = loadGraphFile(argv[1]);
+        if (graph == NULL)
+            return 1;
+        startVertex = argc > 2 ? atoi(argv[2]) : 0;
+        if (startVertex < 0 || startVertex >= graph->numVertices) {
+            printf("Start vertex must be between 0 and %d\n", graph->numVertices - 1);
+            return 1;
+        }
+    } else {
+        /* Example graph:
+             0 --- 1
+             |     |
+             |     |
+             2 --- 3
+        */
+        graph = createGraph(4);
+        
+        addEdge(graph, 0, 1);
+        addEdge(graph, 0, 2);
+        addEdge(graph, 1, 3);
+        addEdge(graph, 2, 3);
+    }
     
     printf("Depth First Search (DFS) Graph Traversal\n");
     printf("=========================================\n\n");
     
-    DFS_Recursive(graph, 0);
-    DFS_Iterative(graph, 0);
+    DFS_Recursive(graph, startVertex);
+    DFS_Iterative(graph, startVertex);
     
     // Free allocated memory
-    for (int i = 0; i < graph->numVertices; i++)
-        free(graph->adjMatrix[i]);
-    free(graph->adjMatrix);
-    free(graph);
+    freeGraph(graph);
+    
+    // The same graph in CSR form with the explicit-stack engine
+    int src[4] = {0, 0, 1, 2};
+    int dest[4] = {1, 2, 3, 3};
+    if (argc == 1) {
+        struct CSRGraph* csr = createCSRGraph(4, 4, src, dest);
+        int parent[4], discovery[4], finish[4];
+        dfsCSR(csr, 0, parent, discovery, finish);
+        printf("\nExplicit-stack DFS on the same graph in CSR form:\n");
+        printf("Vertex \t Discovery \t Finish \t Parent\n");
+        for (int v = 0; v < 4; v++)
+            printf("%d \t %d \t\t %d \t\t %d\n", v, discovery[v], finish[v], parent[v]);
+        freeCSRGraph(csr);
+        
+        // Analyses on the DFS engine: 0 - 1 - 2 is a chain hanging off the
+        // cycle 2 - 3 - 4; in the directed graph 0 -> 1 -> 2 -> 0 is a cycle
+        // and 1 -> 3 -> 4 leaves it, so 3 and 4 are components of their own
+        int usrc[5] = {0, 1, 2, 3, 4};
+        int udest[5] = {1, 2, 3, 4, 2};
+        csr = createCSRGraph(5, 5, usrc, udest);
+        bool isCut[5];
+        int bridgeU[4], bridgeV[4], numBridges;
+        articulationPointsAndBridges(csr, isCut, bridgeU, bridgeV, &numBridges);
+        printf("\nArticulation points of 0-1-2, 2-3-4-2:");
+        for (int v = 0; v < 5; v++)
+            if (isCut[v])
+                printf(" %d", v);
+        printf("\nBridges:");
+        for (int b = 0; b < numBridges; b++)
+            printf(" %d-%d", bridgeU[b], bridgeV[b]);
+        printf("\n");
+        freeCSRGraph(csr);
+        
+        int dsrc[5] = {0, 1, 1, 2, 3};
+        int ddest[5] = {1, 2, 3, 0, 4};
+        csr = createDirectedCSRGraph(5, 5, dsrc, ddest);
+        int component[5];
+        printf("Strongly connected components of 0->1->2->0, 1->3->4: %d (", stronglyConnectedComponents(csr, component));
+        for (int v = 0; v < 5; v++)
+            printf("%s%d", v ? " " : "", component[v]);
+        printf(")\n");
+        freeCSRGraph(csr);
+    }
+    
+    // Cross-check the engine against recursion, which still fits the C stack here
+    printf("\nChecking explicit-stack DFS against recursive DFS: %s\n",
+           checkEngine(2000, 3000, 1) && checkEngine(5000, 50000, 2) && checkEngine(300, 100, 3) ? "PASSED" : "FAILED");
+    printf("Checking SCCs, topological sort, articulation points and bridges against brute force: %s\n",
+           checkAnalyses(60, 70, 1) && checkAnalyses(80, 200, 2) && checkAnalyses(40, 30, 3) ? "PASSED" : "FAILED");
+    printf("Checking the analyses on reordered graphs mapped back to the input numbering: %s\n",
+           checkReorder(40, 1) && checkReorder(25, 2) ? "PASSED" : "FAILED");
     
     return 0;
 }
@@ -5,11 +5,13 @@ echo "Compiling all programs..."
 echo ""
 
 # Compile graph algorithms
-gcc -o 1_dijkstra 1_dijkstra.c && echo "✓ Compiled 1_dijkstra"
-gcc -o 2_prims 2_prims.c && echo "✓ Compiled 2_prims"
-gcc -o 3_kruskal 3_kruskal.c && echo "✓ Compiled 3_kruskal"
-gcc -o 4_bfs 4_bfs.c && echo "✓ Compiled 4_bfs"
-gcc -o 5_dfs 5_dfs.c && echo "✓ Compiled 5_dfs"
+gcc -O2 -pthread -o 1_dijkstra 1_dijkstra.c -lm && echo "✓ Compiled 1_dijkstra"
+gcc -O2 -o 2_prims 2_prims.c && echo "✓ Compiled 2_prims"
+gcc -O2 -pthread -o 3_kruskal 3_kruskal.c && echo "✓ Compiled 3_kruskal"
+gcc -O2 -pthread -o 4_bfs 4_bfs.c && echo "✓ Compiled 4_bfs"
+gcc -O2 -o 5_dfs 5_dfs.c && echo "✓ Compiled 5_dfs"
+gcc -O2 -o graph_convert graph_convert.c && echo "✓ Compiled graph_convert"
+gcc -O2 -pthread -o union_find union_find.c && echo "✓ Compiled union_find"
 
 # Compile tree algorithms
 gcc -o 6_bst 6_bst.c && echo "✓ Compiled 6_bst"
@@ -0,0 +1,274 @@
+/*
+ * Converter from text edge lists to the binary graph file format
+ *
+ * Reads a DIMACS shortest path file (.gr) or a SNAP edge list and writes a
+ * graph file (see graph_file.h) that every graph program can memory-map.
+ *
+ * Input formats:
+ * - DIMACS: "c ..." comment lines, one "p sp V E" line, then one
+ *           "a u v w" line per arc with vertices numbered from 1
+ * - SNAP:   "# ..." comment lines, then one "u v" or "u v w" line per edge
+ *           with vertices numbered from 0 (weight 1 if missing)
+ *
+ * Pseudocode:
+ * 1. Read every edge (src, dest, weight) into growable arrays,
+ *    adding the reverse edge as well if the graph is undirected
+ * 2. Count the out-degree of every vertex
+ * 3. Prefix sums of the degrees give rowStart[]
+ * 4. Scatter every edge into its row of adj[] and weight[]
+ * 5. Write the header and the three arrays
+ *
+ * --reorder rcm|degree|community|random renumbers the vertices for cache
+ * locality before writing (see graph_reorder.h) and writes the permutation
+ * to output.bin.perm: line v holds the new number of input vertex v, so
+ * results on the new file can be mapped back to the input numbering. The
+ * permutation is written after the graph file has been written and checked;
+ * if it cannot be written, the graph file is removed again, since it is of
+ * no use without its permutation.
+ *
+ * Time Complexity: O(V + E)
+ * Space Complexity: O(V + E)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph_file.h"
+#include "graph_reorder.h"
+
+// Growable edge list read from the text file
+struct EdgeList {
+    int* src;
+    int* dest;
+    int* weight;
+    long size;
+    long capacity;
+};
+
+// Append one edge, doubling the arrays when they are full
+bool addEdge(struct EdgeList* edges, long src, long dest, long weight) {
+    if (edges->size == INT_MAX) {
+        printf("Too many edges: the graph file format holds at most %d\n", INT_MAX);
+        return false;
+    }
+    if (edges->size == edges->capacity) {
+        edges->capacity = edges->capacity ? 2 * edges->capacity : 1024;
+        edges->src = (int*)realloc(edges->src, edges->capacity * sizeof(int));
+        edges->dest = (int*)realloc(edges->dest, edges->capacity * sizeof(int));
+        edges->weight = (int*)realloc(edges->weight, edges->capacity * sizeof(int));
+    }
+    edges->src[edges->size] = (int)src;
+    edges->dest[edges->size] = (int)dest;
+    edges->weight[edges->size] = (int)weight;
+    edges->size++;
+    return true;
+}
+
+// Read a DIMACS or SNAP file, returns the number of vertices or -1 on error
+// Lines are read whole with getline(), so a long comment is never split into
+// a second line that would be parsed as an edge
+int readEdgeList(FILE* in, bool undirected, struct EdgeList* edges) {
+    char* line = NULL;
+    size_t capacity = 0;
+    long lineNumber = 0;
+    long declaredVertices = -1;  // From the DIMACS "p" line
+    long maxVertex = -1;
+    bool ok = true;
+
+    while (ok && getline(&line, &capacity, in) != -1) {
+        lineNumber++;
+        long u, v, w = 1;
+        int fields;
+
+        if (line[0] == 'c' || line[0] == '#' || line[0] == '%' || line[0] == '\n' || line[0] == '\r')
+            continue;
+        if (line[0] == 'p') {
+            long arcs;
+            if (sscanf(line, "p %*s %ld %ld", &declaredVertices, &arcs) != 2 || declaredVertices < 0
+                || declaredVertices >= INT_MAX) {
+                printf("Line %ld: bad problem line\n", lineNumber);
+                ok = false;
+            }
+            continue;
+        }
+        if (line[0] == 'a') {
+            // DIMACS arcs are numbered from 1
+            fields = sscanf(line, "a %ld %ld %ld", &u, &v, &w);
+            u--;
+            v--;
+        } else {
+            fields = sscanf(line, "%ld %ld %ld", &u, &v, &w);
+            if (fields == 2)
+                fields = 3;
+        }
+
+        if (fields != 3 || u < 0 || v < 0 || u >= INT_MAX - 1 || v >= INT_MAX - 1) {
+            printf("Line %ld: bad edge\n", lineNumber);
+            ok = false;
+        } else if (w < 0 || w > INT_MAX) {
+            printf("Line %ld: weight must be between 0 and %d\n", lineNumber, INT_MAX);
+            ok = false;
+        } else {
+            ok = addEdge(edges, u, v, w) && (!undirected || u == v || addEdge(edges, v, u, w));
+            if (u > maxVertex)
+                maxVertex = u;
+            if (v > maxVertex)
+                maxVertex = v;
+        }
+    }
+    free(line);
+    if (!ok)
+        return -1;
+
+    if (declaredVertices >= 0) {
+        if (maxVertex >= declaredVertices) {
+            printf("Vertex %ld is outside the %ld vertices of the problem line\n", maxVertex + 1, declaredVertices);
+            return -1;
+        }
+        return (int)declaredVertices;
+    }
+    return (int)(maxVertex + 1);
+}
+
+// Function to write newId[] as text, one line per input vertex
+// A partly written file is removed again
+bool writePermutation(const char* path, int numVertices, const int newId[]) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        printf("Cannot open %s for writing\n", path);
+        return false;
+    }
+    bool ok = true;
+    for (int v = 0; v < numVertices && ok; v++)
+        ok = fprintf(out, "%d\n", newId[v]) > 0;
+    if (fclose(out) != 0 || !ok) {
+        printf("Error writing %s\n", path);
+        remove(path);
+        return false;
+    }
+    return true;
+}
+
+// Driver program: graph_convert input.txt output.bin [--undirected] [--reorder order]
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Usage: %s input.txt output.bin [--undirected] [--reorder rcm|degree|community|random]\n", argv[0]);
+        printf("Converts a DIMACS (.gr) or SNAP edge list to a binary graph file.\n");
+        printf("--undirected stores every edge in both directions.\n");
+        printf("--reorder renumbers the vertices for cache locality and writes the\n");
+        printf("permutation (new number of every input vertex) to output.bin.perm.\n");
+        return 1;
+    }
+    bool undirected = false;
+    enum ReorderType order = REORDER_NONE;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--undirected") == 0) {
+            undirected = true;
+        } else if (strcmp(argv[i], "--reorder") == 0) {
+            if (i + 1 == argc || parseReorder(argv[i + 1]) <= REORDER_NONE) {
+                if (i + 1 == argc)
+                    printf("--reorder needs an order:");
+                else
+                    printf("Unknown order \"%s\" for --reorder, valid orders are:", argv[i + 1]);
+                for (int t = REORDER_NONE + 1; t < NUM_REORDER_TYPES; t++)
+                    printf(" %s", reorderName((enum ReorderType)t));
+                printf("\n");
+                return 1;
+            }
+            order = (enum ReorderType)parseReorder(argv[++i]);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    FILE* in = fopen(argv[1], "r");
+    if (in == NULL) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    struct EdgeList edges = { NULL, NULL, NULL, 0, 0 };
+    int numVertices = readEdgeList(in, undirected, &edges);
+    fclose(in);
+    if (numVertices < 0)
+        return 1;
+    int numEdges = (int)edges.size;
+
+    // Counting sort of the edges by source vertex
+    int* rowStart = (int*)calloc((size_t)numVertices + 1, sizeof(int));
+    int* adj = (int*)malloc(((size_t)numEdges + 1) * sizeof(int));
+    int* weight = (int*)malloc(((size_t)numEdges + 1) * sizeof(int));
+    for (int i = 0; i < numEdges; i++)
+        rowStart[edges.src[i] + 1]++;
+    for (int u = 0; u < numVertices; u++)
+        rowStart[u + 1] += rowStart[u];
+    int* next = (int*)malloc(((size_t)numVertices + 1) * sizeof(int));
+    memcpy(next, rowStart, ((size_t)numVertices + 1) * sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        int e = next[edges.src[i]]++;
+        adj[e] = edges.dest[i];
+        weight[e] = edges.weight[i];
+    }
+    free(next);
+    free(edges.src);
+    free(edges.dest);
+    free(edges.weight);
+
+    int* newId = NULL;
+    if (order != REORDER_NONE) {
+        newId = (int*)malloc(((size_t)numVertices + 1) * sizeof(int));
+        int* newRowStart = (int*)malloc(((size_t)numVertices + 1) * sizeof(int));
+        int* newAdj = (int*)malloc(((size_t)numEdges + 1) * sizeof(int));
+        int* newWeight = (int*)malloc(((size_t)numEdges + 1) * sizeof(int));
+        computeOrder(order, numVertices, rowStart, adj, 1, newId);
+        permuteCSR(numVertices, rowStart, adj, weight, newId, newRowStart, newAdj, newWeight);
+        printf("Reordered (%s): average edge gap %.1f -> %.1f\n", reorderName(order),
+               averageEdgeGap(numVertices, rowStart, adj), averageEdgeGap(numVertices, newRowStart, newAdj));
+        free(rowStart);
+        free(adj);
+        free(weight);
+        rowStart = newRowStart;
+        adj = newAdj;
+        weight = newWeight;
+    }
+
+    bool ok = writeGraphFile(argv[2], numVertices, numEdges, rowStart, adj, weight, !undirected);
+    free(rowStart);
+    free(adj);
+    free(weight);
+    if (!ok) {
+        free(newId);
+        return 1;
+    }
+
+    // Read the result back to make sure it maps and is consistent
+    struct GraphFile* file = openGraphFile(argv[2]);
+    if (file == NULL) {
+        printf("Verification of %s failed\n", argv[2]);
+        free(newId);
+        return 1;
+    }
+    printf("Wrote %s: %d vertices, %d %s edges\n", argv[2], file->numVertices, file->numEdges,
+           file->directed ? "directed" : "stored (undirected, both directions)");
+    closeGraphFile(file);
+
+    // The permutation goes last; without it the reordered graph is unusable
+    if (newId != NULL) {
+        size_t length = strlen(argv[2]);
+        char* permPath = (char*)malloc(length + 6);
+        memcpy(permPath, argv[2], length);
+        memcpy(permPath + length, ".perm", 6);
+        ok = writePermutation(permPath, numVertices, newId);
+        if (ok) {
+            printf("Wrote %s\n", permPath);
+        } else {
+            remove(argv[2]);
+            printf("Removed %s\n", argv[2]);
+        }
+        free(permPath);
+        free(newId);
+    }
+    return ok ? 0 : 1;
+}
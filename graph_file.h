@@ -0,0 +1,205 @@
+/*
+ * Binary Graph File Format shared by the graph programs
+ *
+ * A graph file holds a graph in Compressed Sparse Row (CSR) form so that it
+ * can be memory-mapped and used in place, with no parsing:
+ *
+ *   offset 0          header (struct GraphFileHeader, 64 bytes)
+ *   rowStartOffset    int32 rowStart[V + 1]  edges of u are rowStart[u] .. rowStart[u+1]-1
+ *   adjOffset         int32 adj[E]           target vertex of each edge
+ *   weightOffset      int32 weight[E]        weight of each edge
+ *
+ * Every array starts on a 64-byte boundary. Numbers are stored in the byte
+ * order of the machine that wrote the file (little-endian on x86 and ARM).
+ * Undirected graphs store every edge in both directions and do not set
+ * GRAPH_FILE_DIRECTED, so programs that need each edge once keep u < v.
+ *
+ * Pseudocode for opening a file:
+ * 1. open() the file and read its size with fstat()
+ * 2. mmap() the whole file (pages are only read from disk when touched)
+ * 3. Check the magic, version and that every array lies inside the file
+ * 4. Point rowStart, adj and weight into the mapping
+ * 5. Check that rowStart[] starts at 0, never decreases and ends at E, and
+ *    that every adj[] entry is a vertex
+ * Step 5 reads rowStart[] and adj[] once (O(V + E)), but afterwards no
+ * program can index outside the mapping, whatever the file holds.
+ *
+ * The mapping is private and writable, so a program may change weights in
+ * place; changed pages are copied in memory and the file is never modified.
+ *
+ * Use graph_convert.c to create graph files from DIMACS or SNAP text files.
+ */
+
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define GRAPH_FILE_MAGIC "DSAGRAPH"
+#define GRAPH_FILE_VERSION 1
+#define GRAPH_FILE_DIRECTED 1u   // Flag: edges are one-way
+#define GRAPH_FILE_ALIGN 64
+
+// On-disk header at the start of every graph file
+struct GraphFileHeader {
+    char magic[8];             // "DSAGRAPH"
+    uint32_t version;          // GRAPH_FILE_VERSION
+    uint32_t flags;            // GRAPH_FILE_DIRECTED or 0
+    int64_t numVertices;
+    int64_t numEdges;          // Stored edges (twice the edge count if undirected)
+    int64_t rowStartOffset;    // Byte offsets of the arrays from the start of the file
+    int64_t adjOffset;
+    int64_t weightOffset;
+    int64_t reserved;          // Zero, pads the header to 64 bytes
+};
+
+// A graph file mapped into memory
+struct GraphFile {
+    int numVertices;
+    int numEdges;
+    bool directed;
+    int* rowStart;   // All three arrays point into the mapping
+    int* adj;
+    int* weight;
+    void* map;
+    size_t mapSize;
+};
+
+// Round a byte offset up to the next array boundary
+static inline int64_t graphFileAlign(int64_t offset) {
+    return (offset + GRAPH_FILE_ALIGN - 1) / GRAPH_FILE_ALIGN * GRAPH_FILE_ALIGN;
+}
+
+// Check that CSR row offsets run monotonically from 0 to numEdges and every
+// target is a vertex (also used by programs that load their own CSR files)
+static inline bool verifyCSRArrays(int numVertices, int numEdges, const int rowStart[], const int adj[]) {
+    if (rowStart[0] != 0 || rowStart[numVertices] != numEdges)
+        return false;
+    for (int u = 0; u < numVertices; u++)
+        if (rowStart[u] > rowStart[u + 1])
+            return false;
+    for (int e = 0; e < numEdges; e++)
+        if (adj[e] < 0 || adj[e] >= numVertices)
+            return false;
+    return true;
+}
+
+// Function to map a graph file, returns NULL (after printing why) on failure
+static inline struct GraphFile* openGraphFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        printf("Cannot open %s\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(struct GraphFileHeader)) {
+        printf("%s is too small to be a graph file\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping stays valid after the descriptor is closed
+    if (map == MAP_FAILED) {
+        printf("Cannot map %s\n", path);
+        return NULL;
+    }
+
+    // Validate the header before trusting any offset in it
+    const struct GraphFileHeader* header = (const struct GraphFileHeader*)map;
+    int64_t n = header->numVertices, m = header->numEdges;
+    bool ok = memcmp(header->magic, GRAPH_FILE_MAGIC, 8) == 0
+        && header->version == GRAPH_FILE_VERSION
+        && n >= 0 && n < INT32_MAX && m >= 0 && m <= INT32_MAX
+        && header->rowStartOffset >= (int64_t)sizeof(struct GraphFileHeader)
+        && header->rowStartOffset % GRAPH_FILE_ALIGN == 0
+        && header->adjOffset % GRAPH_FILE_ALIGN == 0
+        && header->weightOffset % GRAPH_FILE_ALIGN == 0
+        && header->rowStartOffset + (n + 1) * 4 <= (int64_t)size
+        && header->adjOffset >= header->rowStartOffset + (n + 1) * 4
+        && header->adjOffset + m * 4 <= (int64_t)size
+        && header->weightOffset >= header->adjOffset + m * 4
+        && header->weightOffset + m * 4 <= (int64_t)size;
+    if (!ok) {
+        printf("%s is not a valid graph file\n", path);
+        munmap(map, size);
+        return NULL;
+    }
+
+    struct GraphFile* file = (struct GraphFile*)malloc(sizeof(struct GraphFile));
+    file->numVertices = (int)n;
+    file->numEdges = (int)m;
+    file->directed = (header->flags & GRAPH_FILE_DIRECTED) != 0;
+    file->rowStart = (int*)((char*)map + header->rowStartOffset);
+    file->adj = (int*)((char*)map + header->adjOffset);
+    file->weight = (int*)((char*)map + header->weightOffset);
+    file->map = map;
+    file->mapSize = size;
+
+    // Every consumer indexes with these arrays, so check them once here
+    if (!verifyCSRArrays(file->numVertices, file->numEdges, file->rowStart, file->adj)) {
+        printf("%s has an invalid rowStart or adj array\n", path);
+        munmap(map, size);
+        free(file);
+        return NULL;
+    }
+    return file;
+}
+
+// Function to unmap a graph file; arrays taken from it become invalid
+static inline void closeGraphFile(struct GraphFile* file) {
+    munmap(file->map, file->mapSize);
+    free(file);
+}
+
+// Function to write a CSR graph as a graph file, returns false on failure
+static inline bool writeGraphFile(const char* path, int numVertices, int numEdges,
+                                  const int rowStart[], const int adj[], const int weight[],
+                                  bool directed) {
+    struct GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_FILE_MAGIC, 8);
+    header.version = GRAPH_FILE_VERSION;
+    header.flags = directed ? GRAPH_FILE_DIRECTED : 0;
+    header.numVertices = numVertices;
+    header.numEdges = numEdges;
+    header.rowStartOffset = graphFileAlign(sizeof(header));
+    header.adjOffset = graphFileAlign(header.rowStartOffset + (int64_t)(numVertices + 1) * 4);
+    header.weightOffset = graphFileAlign(header.adjOffset + (int64_t)numEdges * 4);
+
+    FILE* out = fopen(path, "wb");
+    if (out == NULL) {
+        printf("Cannot open %s for writing\n", path);
+        return false;
+    }
+
+    // Write each array at its offset, zero-filling the padding in between
+    static const char padding[GRAPH_FILE_ALIGN] = {0};
+    const void* arrays[3] = { rowStart, adj, weight };
+    int64_t offsets[3] = { header.rowStartOffset, header.adjOffset, header.weightOffset };
+    int64_t counts[3] = { (int64_t)numVertices + 1, numEdges, numEdges };
+    int64_t position = sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (int i = 0; i < 3 && ok; i++) {
+        ok = fwrite(padding, 1, offsets[i] - position, out) == (size_t)(offsets[i] - position)
+            && fwrite(arrays[i], 4, counts[i], out) == (size_t)counts[i];
+        position = offsets[i] + counts[i] * 4;
+    }
+
+    if (fclose(out) != 0 || !ok) {
+        printf("Error writing %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+#endif
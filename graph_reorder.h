@@ -0,0 +1,409 @@
+/*
+ * Vertex Reordering for Cache Locality, shared by the graph programs
+ *
+ * A search touches the rows and the per-vertex arrays (parent, depth,
+ * dist, ...) of the neighbours of every vertex it expands. If vertices are
+ * numbered in whatever order the input used, neighbours are scattered over
+ * the whole array and nearly every access misses the cache. Renumbering the
+ * vertices so that neighbours get close numbers makes the same search touch
+ * far fewer cache lines and pages.
+ *
+ * An order is a permutation newId[]: old vertex v becomes newId[v].
+ * oldId[newId[v]] == v maps results of the relabelled graph back, e.g.
+ * dist[v] = relabelledDist[newId[v]].
+ *
+ * Orders:
+ * - Degree: vertices by decreasing degree (counting sort, stable). The hubs
+ *   that most edges lead to share a few cache lines
+ * - Reverse Cuthill-McKee (RCM): BFS order with the neighbours of every
+ *   vertex taken by increasing degree, reversed. Neighbours end up at most
+ *   a few BFS levels apart, which keeps the bandwidth (largest |newId[u] -
+ *   newId[v]| over the edges) small; best on meshes and road networks
+ * - Community: a cheap stand-in for Rabbit order. Label propagation groups
+ *   densely connected vertices, then every community is numbered
+ *   consecutively in BFS order from its first vertex
+ * - Random: a random permutation, the worst case, used as a baseline
+ *
+ * Pseudocode for RCM:
+ * 1. Start from an unvisited vertex of minimum degree and move to a
+ *    pseudo-peripheral vertex: repeat BFS from the start and take the
+ *    minimum degree vertex of the last level while the depth grows
+ * 2. BFS from that vertex; append the unvisited neighbours of each vertex
+ *    sorted by increasing degree
+ * 3. Repeat from 1 for every component, then reverse the whole order
+ *
+ * The orders follow out-edges; on directed graphs they still group vertices
+ * that are reached from each other, just less tightly.
+ *
+ * permuteCSR() builds the relabelled CSR arrays with every row sorted by
+ * new vertex number, so a row is also read in increasing memory order.
+ *
+ * Hardware cache misses are read with perf_event_open() where the kernel
+ * allows it; averageEdgeGap() gives a machine-independent measure of the
+ * same effect.
+ *
+ * Time Complexity: O(V + E) for degree and random, O(V + E log d) for RCM
+ * (d the largest degree), O(rounds * (V + E)) for community
+ * Space Complexity: O(V)
+ */
+
+#ifndef GRAPH_REORDER_H
+#define GRAPH_REORDER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define REORDER_RCM_PERIPHERAL_TRIES 4   // BFS restarts while looking for a peripheral vertex
+#define REORDER_COMMUNITY_ROUNDS 8       // Label propagation rounds
+
+enum ReorderType { REORDER_NONE, REORDER_DEGREE, REORDER_RCM, REORDER_COMMUNITY, REORDER_RANDOM };
+
+#define NUM_REORDER_TYPES 5
+
+static inline const char* reorderName(enum ReorderType type) {
+    static const char* names[NUM_REORDER_TYPES] = { "none", "degree", "rcm", "community", "random" };
+    return names[type];
+}
+
+// Function to parse an order name, returns -1 if unknown
+static inline int parseReorder(const char* name) {
+    for (int t = 0; t < NUM_REORDER_TYPES; t++)
+        if (strcmp(name, reorderName((enum ReorderType)t)) == 0)
+            return t;
+    return -1;
+}
+
+static inline int reorderDegree(const int rowStart[], int v) {
+    return rowStart[v + 1] - rowStart[v];
+}
+
+static inline int compareReorderKeys(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Function to number the vertices by decreasing degree
+static inline void degreeOrder(int numVertices, const int rowStart[], int newId[]) {
+    int maxDegree = 0;
+    for (int v = 0; v < numVertices; v++)
+        if (reorderDegree(rowStart, v) > maxDegree)
+            maxDegree = reorderDegree(rowStart, v);
+
+    // Counting sort: count[d] becomes the first number of degree d
+    int* count = (int*)calloc((size_t)maxDegree + 2, sizeof(int));
+    for (int v = 0; v < numVertices; v++)
+        count[maxDegree - reorderDegree(rowStart, v) + 1]++;
+    for (int d = 0; d < maxDegree; d++)
+        count[d + 1] += count[d];
+    for (int v = 0; v < numVertices; v++)
+        newId[v] = count[maxDegree - reorderDegree(rowStart, v)]++;
+    free(count);
+}
+
+// BFS from source over the vertices with level[] == -1, appending them to
+// queue[] from position head; neighbours are appended by increasing degree
+// when sortByDegree is set. keys[] is scratch for one row. Returns the new
+// end of the queue
+static inline int reorderBFS(const int rowStart[], const int adj[], int source, int head,
+                             int queue[], int level[], uint64_t keys[], bool sortByDegree) {
+    int tail = head;
+    queue[tail++] = source;
+    level[source] = 0;
+    while (head < tail) {
+        int u = queue[head++];
+        int first = tail;
+        for (int e = rowStart[u]; e < rowStart[u + 1]; e++) {
+            int v = adj[e];
+            if (level[v] == -1) {
+                level[v] = level[u] + 1;
+                queue[tail++] = v;
+            }
+        }
+        if (sortByDegree && tail - first > 1) {
+            for (int i = first; i < tail; i++)
+                keys[i - first] = (uint64_t)reorderDegree(rowStart, queue[i]) << 32 | (uint32_t)queue[i];
+            qsort(keys, tail - first, sizeof(uint64_t), compareReorderKeys);
+            for (int i = first; i < tail; i++)
+                queue[i] = (int)(uint32_t)keys[i - first];
+        }
+    }
+    return tail;
+}
+
+// Function to number the vertices in Reverse Cuthill-McKee order
+static inline void rcmOrder(int numVertices, const int rowStart[], const int adj[], int newId[]) {
+    int maxDegree = 0;
+    for (int v = 0; v < numVertices; v++)
+        if (reorderDegree(rowStart, v) > maxDegree)
+            maxDegree = reorderDegree(rowStart, v);
+    int* queue = (int*)malloc((size_t)numVertices * sizeof(int));
+    int* level = (int*)malloc((size_t)numVertices * sizeof(int));
+    uint64_t* keys = (uint64_t*)malloc(((size_t)maxDegree + 1) * sizeof(uint64_t));
+    for (int v = 0; v < numVertices; v++)
+        level[v] = -1;
+
+    // Try start vertices by increasing degree: the decreasing degree order
+    // read backwards
+    degreeOrder(numVertices, rowStart, newId);
+    int* byDegree = (int*)malloc((size_t)numVertices * sizeof(int));
+    for (int v = 0; v < numVertices; v++)
+        byDegree[numVertices - 1 - newId[v]] = v;
+
+    // On a directed graph the search from the peripheral vertex may miss
+    // byDegree[i], so i only moves on once it has been numbered
+    int ordered = 0;
+    for (int i = 0; i < numVertices; ) {
+        if (level[byDegree[i]] != -1) {
+            i++;
+            continue;
+        }
+
+        // Move towards a pseudo-peripheral vertex; every trial BFS covers
+        // the component and is undone afterwards
+        int start = byDegree[i], trial = start, depth = -1;
+        for (int t = 0; t < REORDER_RCM_PERIPHERAL_TRIES; t++) {
+            int end = reorderBFS(rowStart, adj, trial, ordered, queue, level, keys, false);
+            int last = queue[end - 1];
+            int candidate = last;
+            for (int j = end - 1; j >= ordered && level[queue[j]] == level[last]; j--)
+                if (reorderDegree(rowStart, queue[j]) < reorderDegree(rowStart, candidate))
+                    candidate = queue[j];
+            int newDepth = level[last];
+            for (int j = ordered; j < end; j++)
+                level[queue[j]] = -1;
+            if (newDepth <= depth)
+                break;
+            depth = newDepth;
+            start = trial;
+            trial = candidate;
+        }
+        ordered = reorderBFS(rowStart, adj, start, ordered, queue, level, keys, true);
+    }
+
+    for (int i = 0; i < numVertices; i++)
+        newId[queue[i]] = numVertices - 1 - i;
+    free(queue);
+    free(level);
+    free(keys);
+    free(byDegree);
+}
+
+// Function to number the vertices community by community
+// Label propagation: every vertex repeatedly takes the label most common
+// among its neighbours (keeping its own on ties), so labels spread through
+// dense groups and stop at sparse cuts
+static inline void communityOrder(int numVertices, const int rowStart[], const int adj[], int newId[]) {
+    int* label = (int*)malloc((size_t)numVertices * sizeof(int));
+    int* count = (int*)calloc((size_t)numVertices, sizeof(int));
+    int* touched = (int*)malloc((size_t)numVertices * sizeof(int));
+    for (int v = 0; v < numVertices; v++)
+        label[v] = v;
+
+    for (int round = 0; round < REORDER_COMMUNITY_ROUNDS; round++) {
+        int changed = 0;
+        for (int v = 0; v < numVertices; v++) {
+            int numTouched = 0;
+            for (int e = rowStart[v]; e < rowStart[v + 1]; e++) {
+                int l = label[adj[e]];
+                if (count[l]++ == 0)
+                    touched[numTouched++] = l;
+            }
+            int best = label[v];
+            for (int i = 0; i < numTouched; i++) {
+                int l = touched[i];
+                if (count[l] > count[best] || (count[l] == count[best] && l < best && best != label[v]))
+                    best = l;
+            }
+            for (int i = 0; i < numTouched; i++)
+                count[touched[i]] = 0;
+            if (best != label[v]) {
+                label[v] = best;
+                changed++;
+            }
+        }
+        if (changed == 0)
+            break;
+    }
+
+    // Number each community in BFS order from its first vertex, staying
+    // inside the community; count[] now marks numbered vertices
+    int* queue = touched;
+    int next = 0;
+    for (int s = 0; s < numVertices; s++) {
+        if (count[s])
+            continue;
+        int head = next, tail = next;
+        queue[tail++] = s;
+        count[s] = 1;
+        while (head < tail) {
+            int u = queue[head++];
+            newId[u] = next++;
+            for (int e = rowStart[u]; e < rowStart[u + 1]; e++) {
+                int v = adj[e];
+                if (!count[v] && label[v] == label[s]) {
+                    count[v] = 1;
+                    queue[tail++] = v;
+                }
+            }
+        }
+    }
+    free(label);
+    free(count);
+    free(touched);
+}
+
+// Function to number the vertices in a random order (Fisher-Yates)
+static inline void randomOrder(int numVertices, uint32_t seed, int newId[]) {
+    uint32_t state = seed ? seed : 1;
+    for (int v = 0; v < numVertices; v++)
+        newId[v] = v;
+    for (int v = numVertices - 1; v > 0; v--) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        int j = (int)(state % (uint32_t)(v + 1));
+        int t = newId[v];
+        newId[v] = newId[j];
+        newId[j] = t;
+    }
+}
+
+// Function to compute the permutation of the given type
+// seed is only used by REORDER_RANDOM
+static inline void computeOrder(enum ReorderType type, int numVertices, const int rowStart[],
+                                const int adj[], uint32_t seed, int newId[]) {
+    switch (type) {
+    case REORDER_DEGREE:
+        degreeOrder(numVertices, rowStart, newId);
+        break;
+    case REORDER_RCM:
+        rcmOrder(numVertices, rowStart, adj, newId);
+        break;
+    case REORDER_COMMUNITY:
+        communityOrder(numVertices, rowStart, adj, newId);
+        break;
+    case REORDER_RANDOM:
+        randomOrder(numVertices, seed, newId);
+        break;
+    default:
+        for (int v = 0; v < numVertices; v++)
+            newId[v] = v;
+    }
+}
+
+// Check that newId[] is a permutation of 0 .. V-1
+static inline bool isPermutation(int numVertices, const int newId[]) {
+    bool* seen = (bool*)calloc((size_t)numVertices, sizeof(bool));
+    bool ok = true;
+    for (int v = 0; v < numVertices && ok; v++) {
+        ok = newId[v] >= 0 && newId[v] < numVertices && !seen[newId[v]];
+        if (ok)
+            seen[newId[v]] = true;
+    }
+    free(seen);
+    return ok;
+}
+
+// Function to fill oldId[] so that oldId[newId[v]] == v
+static inline void inversePermutation(int numVertices, const int newId[], int oldId[]) {
+    for (int v = 0; v < numVertices; v++)
+        oldId[newId[v]] = v;
+}
+
+// Function to relabel a CSR graph: old vertex v becomes newId[v]
+// outRowStart[] holds V + 1 entries, outAdj[] and outWeight[] E entries.
+// weight may be NULL for unweighted graphs (outWeight is then ignored)
+static inline void permuteCSR(int numVertices, const int rowStart[], const int adj[], const int weight[],
+                              const int newId[], int outRowStart[], int outAdj[], int outWeight[]) {
+    int* oldId = (int*)malloc((size_t)numVertices * sizeof(int));
+    inversePermutation(numVertices, newId, oldId);
+    outRowStart[0] = 0;
+    for (int u = 0; u < numVertices; u++)
+        outRowStart[u + 1] = outRowStart[u] + reorderDegree(rowStart, oldId[u]);
+
+    // Sort each row by new target; the weight rides in the low 32 bits
+    int maxDegree = 0;
+    for (int v = 0; v < numVertices; v++)
+        if (reorderDegree(rowStart, v) > maxDegree)
+            maxDegree = reorderDegree(rowStart, v);
+    uint64_t* keys = (uint64_t*)malloc(((size_t)maxDegree + 1) * sizeof(uint64_t));
+    for (int u = 0; u < numVertices; u++) {
+        int old = oldId[u], first = rowStart[old], degree = reorderDegree(rowStart, old);
+        for (int i = 0; i < degree; i++)
+            keys[i] = (uint64_t)newId[adj[first + i]] << 32 | (uint32_t)(weight ? weight[first + i] : 0);
+        qsort(keys, degree, sizeof(uint64_t), compareReorderKeys);
+        for (int i = 0; i < degree; i++) {
+            outAdj[outRowStart[u] + i] = (int)(keys[i] >> 32);
+            if (weight)
+                outWeight[outRowStart[u] + i] = (int)(uint32_t)keys[i];
+        }
+    }
+    free(keys);
+    free(oldId);
+}
+
+// Average |u - v| over the edges: how far apart in memory the per-vertex
+// entries of neighbours are
+static inline double averageEdgeGap(int numVertices, const int rowStart[], const int adj[]) {
+    long double total = 0;
+    for (int u = 0; u < numVertices; u++)
+        for (int e = rowStart[u]; e < rowStart[u + 1]; e++)
+            total += adj[e] > u ? adj[e] - u : u - adj[e];
+    return rowStart[numVertices] ? (double)(total / rowStart[numVertices]) : 0;
+}
+
+// Function to open a counter of last-level cache misses of this thread,
+// returns -1 where hardware counters are not available
+static inline int openCacheMissCounter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static inline void startCacheMissCounter(int fd) {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// Stop the counter and read it, returns -1 without a counter
+static inline long long stopCacheMissCounter(int fd) {
+    long long misses = -1;
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+            misses = -1;
+    }
+#endif
+    return misses;
+}
+
+static inline void closeCacheMissCounter(int fd) {
+    if (fd >= 0)
+        close(fd);
+}
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Union-Find (Disjoint Set) demo and benchmark
+ *
+ * Uses the union_find.h module, which 3_kruskal.c and 2_prims.c also use.
+ *
+ * Pseudocode of the streaming connectivity demo:
+ * 1. Start with every vertex in its own set
+ * 2. For each arriving edge (u, v): Union(u, v)
+ * 3. At any time, "are x and y connected?" is Find(x) == Find(y) and the
+ *    number of components is the number of sets
+ *
+ * The benchmark runs a random mix of unions and connectivity queries on the
+ * sequential version and on the concurrent version with 1, 2, 4, ... threads
+ * and reports millions of operations per second.
+ *
+ * Time Complexity: O(alpha(n)) amortized per operation
+ * Space Complexity: O(n)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "union_find.h"
+
+// Work of one benchmark thread
+struct BenchThread {
+    struct ConcurrentUnionFind* uf;
+    int numOps;
+    int unionPercent;  // Share of unions among the operations
+    uint32_t seed;
+    int connectedCount;
+};
+
+// Simple xorshift random number generator (deterministic for a given seed)
+uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Wall-clock time in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Number of CPUs available to run threads on
+int numCPUs() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+// Random unions and queries on the shared concurrent forest
+void* benchWorker(void* arg) {
+    struct BenchThread* t = (struct BenchThread*)arg;
+    int n = t->uf->numElements;
+    uint32_t state = t->seed;
+    for (int i = 0; i < t->numOps; i++) {
+        int x = xorshift32(&state) % n;
+        int y = xorshift32(&state) % n;
+        if ((int)(xorshift32(&state) % 100) < t->unionPercent)
+            cufUnion(t->uf, x, y);
+        else
+            t->connectedCount += cufConnected(t->uf, x, y);
+    }
+    return NULL;
+}
+
+// Function to time numOps operations on n elements spread over numThreads threads
+double benchConcurrent(int n, int numOps, int unionPercent, int numThreads) {
+    struct ConcurrentUnionFind* uf = createConcurrentUnionFind(n);
+    struct BenchThread* threads = (struct BenchThread*)malloc(numThreads * sizeof(struct BenchThread));
+    pthread_t* ids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        threads[t].uf = uf;
+        threads[t].numOps = numOps / numThreads;
+        threads[t].unionPercent = unionPercent;
+        threads[t].seed = 12345 + 7919 * t;
+        threads[t].connectedCount = 0;
+    }
+
+    double start = nowSeconds();
+    for (int t = 1; t < numThreads; t++)
+        pthread_create(&ids[t], NULL, benchWorker, &threads[t]);
+    benchWorker(&threads[0]);
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(ids[t], NULL);
+    double elapsed = nowSeconds() - start;
+
+    free(threads);
+    free(ids);
+    freeConcurrentUnionFind(uf);
+    return elapsed;
+}
+
+// Function to time the same operation mix on the sequential version
+double benchSequential(int n, int numOps, int unionPercent) {
+    struct UnionFind* uf = createUnionFind(n);
+    uint32_t state = 12345;
+    int connectedCount = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < numOps; i++) {
+        int x = xorshift32(&state) % n;
+        int y = xorshift32(&state) % n;
+        if ((int)(xorshift32(&state) % 100) < unionPercent)
+            ufUnion(uf, x, y);
+        else
+            connectedCount += ufConnected(uf, x, y);
+    }
+    double elapsed = nowSeconds() - start;
+    freeUnionFind(uf);
+    return connectedCount >= 0 ? elapsed : 0;  // Keeps the queries from being optimised away
+}
+
+// Function to print ops/sec of both versions as the thread count grows
+void benchmark(int n, int numOps, int unionPercent, int maxThreads) {
+    printf("%d elements, %d operations, %d%% unions\n\n", n, numOps, unionPercent);
+    printf("Version       Threads   Time       Mops/s\n");
+    double elapsed = benchSequential(n, numOps, unionPercent);
+    printf("sequential    %7d %8.3f s %9.1f\n", 1, elapsed, numOps / elapsed / 1e6);
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        elapsed = benchConcurrent(n, numOps, unionPercent, threads);
+        printf("concurrent    %7d %8.3f s %9.1f\n", threads, elapsed, numOps / elapsed / 1e6);
+    }
+}
+
+// Adds a share of a fixed edge list to the concurrent forest
+struct CheckThread {
+    struct ConcurrentUnionFind* uf;
+    const int* src;
+    const int* dest;
+    int begin, end;
+};
+
+void* checkWorker(void* arg) {
+    struct CheckThread* t = (struct CheckThread*)arg;
+    for (int i = t->begin; i < t->end; i++)
+        cufUnion(t->uf, t->src[i], t->dest[i]);
+    return NULL;
+}
+
+// Function to check that concurrent unions from several threads give the same
+// partition as sequential unions of the same edges
+bool checkConcurrent(int n, int numEdges, int numThreads, uint32_t seed) {
+    int* src = (int*)malloc(numEdges * sizeof(int));
+    int* dest = (int*)malloc(numEdges * sizeof(int));
+    uint32_t state = seed;
+    for (int i = 0; i < numEdges; i++) {
+        src[i] = xorshift32(&state) % n;
+        dest[i] = xorshift32(&state) % n;
+    }
+
+    struct UnionFind* expected = createUnionFind(n);
+    for (int i = 0; i < numEdges; i++)
+        ufUnion(expected, src[i], dest[i]);
+
+    struct ConcurrentUnionFind* actual = createConcurrentUnionFind(n);
+    struct CheckThread* threads = (struct CheckThread*)malloc(numThreads * sizeof(struct CheckThread));
+    pthread_t* ids = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        threads[t].uf = actual;
+        threads[t].src = src;
+        threads[t].dest = dest;
+        threads[t].begin = (int)((long long)numEdges * t / numThreads);
+        threads[t].end = (int)((long long)numEdges * (t + 1) / numThreads);
+    }
+    for (int t = 0; t < numThreads; t++)
+        pthread_create(&ids[t], NULL, checkWorker, &threads[t]);
+    for (int t = 0; t < numThreads; t++)
+        pthread_join(ids[t], NULL);
+
+    // Same partition: the roots must correspond one to one
+    bool ok = expected->numSets == cufNumSets(actual);
+    int* rootMap = (int*)malloc(n * sizeof(int));
+    for (int x = 0; x < n; x++)
+        rootMap[x] = -1;
+    for (int x = 0; x < n && ok; x++) {
+        int a = ufFind(expected, x), b = cufFind(actual, x);
+        if (rootMap[a] == -1)
+            rootMap[a] = b;
+        ok = rootMap[a] == b;
+    }
+
+    free(rootMap);
+    free(threads);
+    free(ids);
+    free(src);
+    free(dest);
+    freeUnionFind(expected);
+    freeConcurrentUnionFind(actual);
+    return ok;
+}
+
+// Driver program to test above functions
+// Usage: ./union_find
+//        ./union_find bench [elements] [operations] [unionPercent] [maxThreads]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int n = argc > 2 ? atoi(argv[2]) : 1000000;
+        int numOps = argc > 3 ? atoi(argv[3]) : 20000000;
+        int unionPercent = argc > 4 ? atoi(argv[4]) : 50;
+        int maxThreads = argc > 5 ? atoi(argv[5]) : numCPUs();
+        if (n < 1 || numOps < 1 || unionPercent < 0 || unionPercent > 100 || maxThreads < 1) {
+            printf("Benchmark needs elements, operations, maxThreads >= 1 and 0 <= unionPercent <= 100\n");
+            return 1;
+        }
+        benchmark(n, numOps, unionPercent, maxThreads);
+        return 0;
+    }
+
+    printf("Union-Find (Disjoint Set)\n");
+    printf("=========================\n\n");
+
+    // Streaming connectivity: edges arrive one at a time
+    int edges[6][2] = { {0, 1}, {2, 3}, {1, 2}, {4, 5}, {3, 0}, {6, 6} };
+    struct UnionFind* uf = createUnionFind(8);
+    printf("8 vertices, %d components\n", uf->numSets);
+    for (int i = 0; i < 6; i++) {
+        bool merged = ufUnion(uf, edges[i][0], edges[i][1]);
+        printf("Edge %d - %d: %s, %d components\n", edges[i][0], edges[i][1],
+               merged ? "merged two sets" : "already connected", uf->numSets);
+    }
+    printf("\n0 and 3 connected: %s\n", ufConnected(uf, 0, 3) ? "yes" : "no");
+    printf("0 and 4 connected: %s\n", ufConnected(uf, 0, 4) ? "yes" : "no");
+    printf("Size of the set of 2: %d\n", ufSetSize(uf, 2));
+    ufReset(uf);
+    printf("After ufReset: %d components, 0 and 3 connected: %s\n", uf->numSets,
+           ufConnected(uf, 0, 3) ? "yes" : "no");
+    freeUnionFind(uf);
+
+    printf("\nChecking concurrent unions against sequential ones: %s\n",
+           checkConcurrent(100000, 80000, 4, 1) && checkConcurrent(1000, 5000, 8, 2) ? "PASSED" : "FAILED");
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Union-Find (Disjoint Set) shared by the graph programs
+ *
+ * Keeps a partition of the elements 0 .. n-1 into sets. Every set is a tree
+ * of parent pointers whose root names the set.
+ *
+ * Pseudocode:
+ * Find(x):
+ * 1. While x is not a root:
+ *    a. Point x to its grandparent (path halving)
+ *    b. Move x to that grandparent
+ * 2. Return x
+ * Union(x, y):
+ * 1. Find the roots of x and y; if they are equal, nothing to do
+ * 2. Attach the root of the smaller set under the root of the larger one
+ *
+ * Path halving is iterative, so deep trees never overflow the stack, and
+ * with union by size every operation takes O(alpha(n)) amortized time.
+ *
+ * ConcurrentUnionFind lets many threads call Find and Union at once
+ * without locks:
+ * - Union links a root with one compare-and-swap on its parent pointer; if
+ *   the root was linked by another thread first, the CAS fails and Union
+ *   retries from the new roots
+ * - Roots are linked by a fixed random priority (a hash of the element)
+ *   instead of by size, so no second field has to change atomically. This
+ *   keeps the expected tree depth logarithmic, like union by rank, and any
+ *   fixed order makes cycles impossible
+ * - Path halving stores a grandparent pointer; the grandparent is always
+ *   still an ancestor, so a racing store is harmless
+ *
+ * Both versions count their sets, so they can answer streaming
+ * connectivity queries ("are x and y connected?", "how many components?")
+ * while edges keep arriving.
+ */
+
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Sequential disjoint-set forest with union by size
+struct UnionFind {
+    int numElements;
+    int numSets;
+    int* parent;  // parent[x] == x for roots
+    int* size;    // size[root] is the number of elements in the set
+};
+
+// Disjoint-set forest that many threads may update at once
+struct ConcurrentUnionFind {
+    int numElements;
+    atomic_int numSets;
+    _Atomic int* parent;
+};
+
+// Function to make every element a singleton set again, reusing the arrays
+static inline void ufReset(struct UnionFind* uf) {
+    uf->numSets = uf->numElements;
+    for (int x = 0; x < uf->numElements; x++) {
+        uf->parent[x] = x;
+        uf->size[x] = 1;
+    }
+}
+
+// Function to create n singleton sets
+static inline struct UnionFind* createUnionFind(int n) {
+    struct UnionFind* uf = (struct UnionFind*)malloc(sizeof(struct UnionFind));
+    uf->numElements = n;
+    uf->parent = (int*)malloc(n * sizeof(int));
+    uf->size = (int*)malloc(n * sizeof(int));
+    ufReset(uf);
+    return uf;
+}
+
+static inline void freeUnionFind(struct UnionFind* uf) {
+    free(uf->parent);
+    free(uf->size);
+    free(uf);
+}
+
+// Find the root of the set containing x, halving the path on the way
+static inline int ufFind(struct UnionFind* uf, int x) {
+    while (uf->parent[x] != x) {
+        uf->parent[x] = uf->parent[uf->parent[x]];
+        x = uf->parent[x];
+    }
+    return x;
+}
+
+// Merge the sets of x and y; returns false if they were already one set
+static inline bool ufUnion(struct UnionFind* uf, int x, int y) {
+    x = ufFind(uf, x);
+    y = ufFind(uf, y);
+    if (x == y)
+        return false;
+
+    // Attach the smaller tree under the larger one
+    if (uf->size[x] < uf->size[y]) {
+        int t = x;
+        x = y;
+        y = t;
+    }
+    uf->parent[y] = x;
+    uf->size[x] += uf->size[y];
+    uf->numSets--;
+    return true;
+}
+
+static inline bool ufConnected(struct UnionFind* uf, int x, int y) {
+    return ufFind(uf, x) == ufFind(uf, y);
+}
+
+// Number of elements in the set containing x
+static inline int ufSetSize(struct UnionFind* uf, int x) {
+    return uf->size[ufFind(uf, x)];
+}
+
+// Function to create n singleton sets for concurrent use
+static inline struct ConcurrentUnionFind* createConcurrentUnionFind(int n) {
+    struct ConcurrentUnionFind* uf = (struct ConcurrentUnionFind*)malloc(sizeof(struct ConcurrentUnionFind));
+    uf->numElements = n;
+    atomic_init(&uf->numSets, n);
+    uf->parent = (_Atomic int*)malloc(n * sizeof(_Atomic int));
+    for (int x = 0; x < n; x++)
+        atomic_init(&uf->parent[x], x);
+    return uf;
+}
+
+static inline void freeConcurrentUnionFind(struct ConcurrentUnionFind* uf) {
+    free((void*)uf->parent);
+    free(uf);
+}
+
+// Fixed random priority of an element (a 32-bit integer hash)
+static inline uint32_t cufPriority(int x) {
+    uint32_t h = (uint32_t)x;
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return h;
+}
+
+// Find the root of the set containing x; safe to call from any thread
+static inline int cufFind(struct ConcurrentUnionFind* uf, int x) {
+    while (true) {
+        int p = atomic_load_explicit(&uf->parent[x], memory_order_relaxed);
+        if (p == x)
+            return x;
+        int grandparent = atomic_load_explicit(&uf->parent[p], memory_order_relaxed);
+        if (grandparent != p)
+            atomic_store_explicit(&uf->parent[x], grandparent, memory_order_relaxed);
+        x = grandparent;
+    }
+}
+
+// Merge the sets of x and y; returns true only for the call that actually
+// linked them, so each merge is reported exactly once across all threads
+static inline bool cufUnion(struct ConcurrentUnionFind* uf, int x, int y) {
+    while (true) {
+        x = cufFind(uf, x);
+        y = cufFind(uf, y);
+        if (x == y)
+            return false;
+
+        // Link the root with the lower priority under the other one
+        uint32_t px = cufPriority(x), py = cufPriority(y);
+        if (px > py || (px == py && x < y)) {
+            int t = x;
+            x = y;
+            y = t;
+        }
+        int expected = x;
+        if (atomic_compare_exchange_weak_explicit(&uf->parent[x], &expected, y,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            atomic_fetch_sub_explicit(&uf->numSets, 1, memory_order_relaxed);
+            return true;
+        }
+        // x stopped being a root in the meantime: retry from the new roots
+    }
+}
+
+// Check whether x and y are in the same set. With concurrent unions the
+// answer is exact for some moment during the call: if the roots differ and
+// x's root is still a root, x and y were apart at that moment
+static inline bool cufConnected(struct ConcurrentUnionFind* uf, int x, int y) {
+    while (true) {
+        x = cufFind(uf, x);
+        y = cufFind(uf, y);
+        if (x == y)
+            return true;
+        if (atomic_load_explicit(&uf->parent[x], memory_order_acquire) == x)
+            return false;
+    }
+}
+
+static inline int cufNumSets(struct ConcurrentUnionFind* uf) {
+    return atomic_load(&uf->numSets);
+}
+
+#endif